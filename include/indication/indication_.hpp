@@ -1,7 +1,9 @@
 #pragma once
 #include "indication/indication_defs.hpp"
 
-#include <string> // Native Libraries
+#include <atomic> // Native Libraries
+#include <cstdarg>
+#include <cstdio>
 
 #include "freertos/FreeRTOS.h" // RTOS Libraries
 #include "freertos/task.h"
@@ -11,26 +13,104 @@
 
 #include "esp_check.h" // ESP Libraries
 #include "esp_log.h"
+#include "esp_partition.h"
+#include "esp_timer.h"
+#if CONFIG_WS2812_PM_LOCK
+#include "esp_pm.h"
+#endif
 
 #include "system_.hpp" // Component Libraries
 
 class System; // Class Declarations
 class NVS;
 
+struct ind_stress_t;
+struct ind_bench_t;
+
 extern "C"
 {
     class Indication
     {
     public:
-        Indication(uint8_t, uint8_t, uint8_t);
+        Indication(uint8_t, uint8_t, uint8_t, int = RMT_LED_STRIP_GPIO_NUM);
         ~Indication();
 
-        TaskHandle_t &getRunTaskHandle(void);
+#if !CONFIG_WS2812_SHARED_SCHEDULER
+        TaskHandle_t &getRunTaskHandle(void); // Not built with the shared scheduler.  A raw notification there can not say which device it is for.
+#endif
         QueueHandle_t &getCmdRequestQueue(void);
+        static int64_t getShutdownLatencyUs(void);
+
+        /* Indication_Queue */
+        esp_err_t submitIndication(uint32_t, TickType_t, IND_PRIORITY = IND_PRIORITY::Routine, ind_ticket_t * = nullptr);
+        void setQueuePolicy(uint8_t);
+        uint8_t getQueuePolicy(void);
+        void setPreemptPolicy(IND_PREEMPT);
+        esp_err_t submitIndicationFromISR(uint32_t, IND_PRIORITY, BaseType_t *);
+
+        /* Indication_Program */
+        esp_err_t registerProgram(const uint32_t *, uint16_t, uint8_t *);
+        esp_err_t submitProgram(uint8_t, TickType_t, IND_PRIORITY = IND_PRIORITY::Routine, ind_ticket_t * = nullptr);
+
+        /* Indication_Pattern */
+        esp_err_t loadPatternTable(const uint32_t *, size_t);
+        esp_err_t mapPatternPartition(const char * = nullptr);
+        esp_err_t submitPattern(uint8_t, TickType_t, IND_PRIORITY = IND_PRIORITY::Routine);
+
+        /* Indication_Schedule */
+        esp_err_t submitIndicationAt(uint32_t, int64_t, TickType_t, IND_PRIORITY = IND_PRIORITY::Routine, ind_ticket_t * = nullptr);
+
+        /* Indication_Settings */
+        esp_err_t setChannelSettings(const ind_settings_t *);
+
+        /* Indication_Layers */
+        esp_err_t openLayer(uint8_t, IND_BLEND, uint8_t *);
+        esp_err_t setLayer(uint8_t, uint8_t, uint8_t, uint8_t, uint8_t = 255);
+        esp_err_t hideLayer(uint8_t);
+        esp_err_t closeLayer(uint8_t);
+
+        /* Indication_Color */
+        esp_err_t setPaletteRGB(uint8_t, uint8_t, uint8_t, uint8_t);
+        esp_err_t setPaletteHSV(uint8_t, uint16_t, uint8_t, uint8_t);
+
+        /* Indication_Snapshot */
+        void getSnapshot(ind_snapshot_t *);
+
+        esp_err_t setPersistentIndication(uint32_t);
+        esp_err_t cancelPersistentIndication(void);
+        void getQueueStats(ind_queue_stats_t *);
+        void resetQueueStats(void);
+
+        /* Indication_Power */
+        void getPowerStats(ind_power_stats_t *);
+        void resetPowerStats(void);
+        static uint32_t estimateFramePower(const uint8_t *, uint16_t);
+        static uint32_t limitFramePower(uint8_t *, uint16_t, uint32_t);
 
         /* Indication_Diagnostics */
         void printTaskInfoByColumns();
 
+        /* Indication_Effects */
+        static void effectChase(uint8_t *, uint16_t, const uint8_t *, uint8_t, uint16_t);
+        static void effectRainbow(uint8_t *, uint16_t, uint16_t, uint16_t);
+        static void effectBreathe(uint8_t *, uint16_t, uint8_t);
+        static void effectWipe(uint8_t *, uint16_t, const uint8_t *, uint32_t);
+        static void hsvToGRB(uint16_t, uint8_t, uint8_t, uint8_t *);
+
+        /* Indication_Timing */
+        void getJitterStats(ind_jitter_t *);
+        void resetJitterStats(void);
+        void printJitterStats(void);
+
+#if CONFIG_WS2812_STRESS_HARNESS
+        /* Indication_Stress */
+        esp_err_t runCmdQueueStressTest(uint8_t producers, uint32_t periodMs, uint32_t durationMs, uint32_t sendTimeoutMs);
+        esp_err_t runClassIsolationTest(uint32_t alarms, uint32_t periodMs);
+        esp_err_t runJitterBenchmark(const ind_bench_load_t *load, uint32_t durationMs);
+        esp_err_t runEffectsBenchmark(uint32_t pixelsPerRun);
+        esp_err_t runHeapCheck(uint32_t commands, uint32_t periodMs);
+#endif
+
     private:
         Indication(const Indication &) = delete;     // Disable copy constructor
         void operator=(Indication const &) = delete; // Disable assignment operator
@@ -45,6 +125,9 @@ extern "C"
         uint8_t minorVer;
         uint8_t patchNumber; // Espressif like to call this 'patch' rather than calling it 'revision'.
 
+        int ledGpio = RMT_LED_STRIP_GPIO_NUM; // Each device drives its own strip
+        char nvsNamespace[16] = "indication"; // Devices on other GPIOs keep their settings apart
+
         uint8_t show = 0; // Flags
         uint8_t showIND = 0;
 
@@ -52,11 +135,32 @@ extern "C"
         void setLogLevels(void);
         void createSemaphores(void);
         void destroySemaphores(void);
+        void releaseEntry(void);
         void createQueues(void);
         void destroyQueues(void);
 
         uint8_t runStackSizeK = 6; // Default/Minimum stacksize
         TaskHandle_t taskHandleRun = nullptr;
+        SemaphoreHandle_t semIndJoin = nullptr; // Given once our last pass is over.  The destructor joins on it.
+        std::atomic<bool> entryHeld{false};     // Our constructor's take of semIndEntry has not been given back yet
+        SemaphoreHandle_t semSubmitLock[IND_PRIORITY_CLASSES] = {}; // One per class.  Makes a submitter's policy decision and its first send one step.
+        static int64_t shutdownUs;              // Time the last destructor spent waiting for the run task
+
+#if CONFIG_WS2812_STATIC_ALLOCATION
+        /* Static Storage */
+        StaticQueue_t cmdRequestQueueBuffer;
+        uint8_t cmdRequestQueueStore[CONFIG_WS2812_CMD_QUEUE_DEPTH * sizeof(uint32_t)];
+        StaticQueue_t priorityQueueBuffer[IND_PRIORITY_CLASSES];
+        uint8_t priorityQueueStore[IND_PRIORITY_CLASSES][CONFIG_WS2812_CMD_QUEUE_DEPTH * sizeof(ind_cmd_t)];
+        StaticQueue_t patternQueueBuffer[IND_PRIORITY_CLASSES];
+        uint8_t patternQueueStore[IND_PRIORITY_CLASSES][CONFIG_WS2812_PATTERN_QUEUE_DEPTH];
+        StaticQueue_t scheduleQueueBuffer;
+        uint8_t scheduleQueueStore[CONFIG_WS2812_SCHEDULE_DEPTH * sizeof(ind_sched_t)];
+        StaticSemaphore_t semIndJoinBuffer;
+        StaticSemaphore_t semSubmitLockBuffer[IND_PRIORITY_CLASSES];
+        StaticSemaphore_t semDwellBuffer;
+        rmt_led_strip_encoder_t ledEncoderStore; // Our part of the encoder.  The bytes and copy encoders inside belong to the RMT driver.
+#endif
 
         IND_OP indOP = IND_OP::Run;                        // Object States
         IND_SHUTDOWN indShdnStep = IND_SHUTDOWN::Finished; //
@@ -94,9 +198,10 @@ extern "C"
         static esp_err_t rmt_led_strip_encoder_reset(rmt_encoder_t *encoder);
 
         /* Indication_Logging */
-        std::string errMsg = ""; // Variable used for "ByValue" call.
-        void routeLogByRef(LOG_TYPE, std::string *);
-        void routeLogByValue(LOG_TYPE, std::string);
+        const char *errFunc = nullptr; // Where the last error happened.  Logged from IND_OP::Error.
+        esp_err_t errCode = ESP_OK;
+        void routeLogByRef(LOG_TYPE, const char *);
+        void routeLogByValue(LOG_TYPE, const char *, ...) __attribute__((format(printf, 3, 4)));
 
         /* Indication_NVS */
         TickType_t startNVSDelayTicks = 0;
@@ -104,6 +209,171 @@ extern "C"
         void restoreVariablesFromNVS(void);
         void saveVariablesToNVS(void);
 
+        /* Indication_Queue */
+        QueueHandle_t queHandleIndPriority[IND_PRIORITY_CLASSES] = {}; // One ind_cmd_t queue for each priority class
+
+        uint8_t quePolicy = IND_QUE_DEFAULT_POLICY;
+        ind_queue_stats_t queStats = {};
+        portMUX_TYPE queLock = portMUX_INITIALIZER_UNLOCKED; // Guards queStats and the pending shadow below
+
+        ind_cmd_t quePending[IND_PRIORITY_CLASSES * (CONFIG_WS2812_CMD_QUEUE_DEPTH + 1)]; // Copy of submitted commands still waiting (Coalesce only)
+        uint8_t quePendingCount = 0;
+
+        IND_PREEMPT preemptPolicy = IND_PREEMPT_DEFAULT_POLICY;
+        ind_cmd_t preempted[IND_PRIORITY_CLASSES]; // Stack of preempted commands.  Priority rises toward the top.
+        uint8_t preemptedCount = 0;
+
+        std::atomic<bool> runWaiting{false}; // The run task is (about to be) blocked on the command queue
+
+        uint32_t persistValue = IND_CMD_WAKE;   // Pattern the run task repeats when nothing else is waiting (IND_CMD_WAKE means none)
+        uint32_t persistRequest = IND_CMD_WAKE; // Hand-off from setPersistentIndication() to the run task (guarded by queLock)
+        bool persistRequestPending = false;
+
+        esp_err_t submitCmd(ind_cmd_t *, TickType_t);
+        bool isCmdPending(const ind_cmd_t *);
+        void addPendingCmd(const ind_cmd_t *);
+        void forgetPendingCmd(const ind_cmd_t *);
+        void wakeRunTask(void);
+        void postNotify(uint32_t);
+        uint32_t takeNotify(void);
+        bool isShutdownPending(void);
+        bool fetchCmd(ind_cmd_t *);
+        bool isPreemptPending(void);
+        void preemptIndication(void);
+        void applyPersistentRequest(void);
+        void signalTicket(ind_ticket_t *, IND_TICKET);
+        void dropWaitingCmds(void);
+
+        /* Indication_Ring */
+        ind_ring_slot_t ring[CONFIG_WS2812_ISR_RING_DEPTH];
+        std::atomic<uint32_t> ringEnqueuePos{0}; // Claimed by producers with a compare and swap
+        uint32_t ringDequeuePos = 0;             // Owned by the run task
+        std::atomic<uint32_t> ringDropped{0}; // Kept apart from queStats because producers may run in interrupt context
+
+        void initIsrRing(void);
+        void drainIsrRing(void);
+
+        /* Indication_Program */
+        ind_program_t programs[CONFIG_WS2812_PROGRAM_SLOTS] = {}; // Validated programs.  A slot is never changed once filled.
+        uint8_t programCount = 0;
+        portMUX_TYPE programLock = portMUX_INITIALIZER_UNLOCKED;
+        ind_prog_state_t prog = {}; // The running program (valid while indState is Program or a classic command inside it plays)
+        bool progActive = false;
+
+        esp_err_t validateProgram(const uint32_t *, uint16_t);
+        void startProgram(uint8_t);
+        void runProgram(const uint32_t *, uint16_t);
+        void stepProgram(void);
+
+        uint32_t versionProgram[IND_VERSION_PROG_WORDS] = {}; // Built at start-up from majorVer, minorVer and patchNumber
+        uint16_t versionLength = 0;
+
+        void startVersionFlash(void);
+
+        /* Indication_Fade */
+        ind_fade_t fade = {};
+
+        void startFade(uint8_t, uint8_t, uint16_t, bool);
+        bool isFading(void);
+        void fadeTick(void);
+        uint8_t fadeLevel(LED_STATE, uint8_t, uint8_t);
+
+        /* Indication_Color */
+        uint8_t palette[IND_PALETTE_SLOTS][3] = {}; // A, B and C levels of each slot.  Written under settingsLock.
+        uint8_t firstPalette[3] = {};               // Palette levels latched when a command starts
+        uint8_t secondPalette[3] = {};
+        bool firstUsesPalette = false;
+        bool secondUsesPalette = false;
+
+        uint8_t latchColorTarget(uint8_t, uint8_t *, bool *);
+
+        /* Indication_Gamma */
+        bool ditherPending = false; // The last frame held a fractional level and must be refreshed
+#if CONFIG_WS2812_DITHER
+        uint8_t ditherAcc[3] = {}; // Fraction carried by each channel (A, B, C)
+        bool stepHadFrame = false; // A frame already went out on this dwell step
+
+        void refreshDither(void);
+#endif
+#if CONFIG_WS2812_GAMMA
+        uint8_t outputLevel(uint8_t, uint8_t);
+#endif
+        bool isDriverHeld(void);
+
+        /* Indication_Pattern */
+        QueueHandle_t queHandleIndPattern[IND_PRIORITY_CLASSES] = {}; // One uint8_t pattern id queue for each priority class
+        const uint32_t *patternTable = nullptr;                        // Set once.  May point into a mapped partition.
+        size_t patternWords = 0;
+        uint8_t patternCount = 0;
+        esp_partition_mmap_handle_t patternMap = 0;
+        bool patternMapped = false;
+
+        esp_err_t validatePatternTable(const uint32_t *, size_t);
+        bool fetchPattern(uint8_t, ind_cmd_t *);
+        void startPattern(uint8_t);
+        void unmapPatternPartition(void);
+
+        /* Indication_Schedule */
+        QueueHandle_t queHandleIndSchedule = nullptr; // Hand-off from submitIndicationAt() to the run task
+        ind_sched_t schedHeap[CONFIG_WS2812_SCHEDULE_DEPTH]; // Min-heap on release time.  Owned by the run task.
+        uint8_t schedCount = 0;
+        uint32_t schedOrder = 0;
+
+        void collectScheduled(void);
+        void releaseDueCmds(void);
+        TickType_t ticksUntilNextRelease(TickType_t);
+        void dropScheduledCmds(void);
+
+#if CONFIG_WS2812_SHARED_SCHEDULER
+        /* Indication_Shared */
+        static Indication *sharedDevices[CONFIG_WS2812_SHARED_DEVICES]; // Every device served by the shared task
+        static TaskHandle_t sharedTask;
+        static portMUX_TYPE sharedLock;
+        static int64_t sharedEdgeUs; // Intended end of the dwell step that just passed
+        static int64_t sharedDueUs;  // Intended end of the next one
+        std::atomic<uint32_t> sharedNotify{0}; // IND_NOTIFY bits for this device.  The shared task's own notification is only a doorbell.
+
+        esp_err_t joinSharedScheduler(void);
+        static void sharedScheduler(void *);
+        static uint8_t sharedDeviceCount(void);
+        static void sharedDwellWait(void);
+        static void sharedDwellStop(void);
+#endif
+
+        /* Indication_Settings */
+        ind_settings_t settingsPending = {}; // Merged changes from every publisher since the run task last looked
+        portMUX_TYPE settingsLock = portMUX_INITIALIZER_UNLOCKED;
+
+        void applyChannelSettings(void);
+
+        /* Indication_Layers */
+        ind_layer_t layers[CONFIG_WS2812_LAYERS] = {}; // Written by their producers under layerLock
+        portMUX_TYPE layerLock = portMUX_INITIALIZER_UNLOCKED;
+        bool layersDirty = false;   // A producer changed a layer since the last composite
+        bool compositeShown = false; // The LED holds the composite.  An indication clears this.
+
+        esp_err_t changeLayer(uint8_t, const ind_layer_t *);
+        void compositeLayers(void);
+
+        /* Indication_Power */
+#if CONFIG_WS2812_PM_LOCK
+        esp_pm_lock_handle_t pmLock = nullptr; // Keeps automatic light sleep away while we hold it
+#endif
+        bool powerHeld = false; // Owned by the run task.  pmStats.held is only the copy readers see.
+        ind_power_stats_t pmStats = {};
+        int64_t pmTakenUs = 0; // When the hold in progress started
+        portMUX_TYPE pmStatsLock = portMUX_INITIALIZER_UNLOCKED;
+
+        void createPowerLock(void);
+        void destroyPowerLock(void);
+        void holdPower(bool);
+
+        /* Indication_Snapshot */
+        ind_snapshot_t snapshot = {};      // Written only by the run task
+        std::atomic<uint32_t> snapSeq{0}; // Odd while the run task is writing the snapshot
+
+        void publishSnapshot(void);
+
         /* Indication_Run */
         bool IsIndicating = false;
 
@@ -115,6 +385,8 @@ extern "C"
         uint8_t bCurrValue = 0;
         uint8_t cCurrValue = 0;
 
+        ind_cmd_t activeCmd = {}; // The command now being shown
+
         uint8_t clearLEDTargets;
         uint8_t setLEDTargets;
 
@@ -134,16 +406,64 @@ extern "C"
         uint8_t second_on_time_counter;
 
         static void runMarshaller(void *);
+#if CONFIG_WS2812_STATIC_ALLOCATION && !CONFIG_WS2812_SHARED_SCHEDULER
+        esp_err_t claimRunTask(void);
+#endif
         void run(void);
+        bool runPass(void);
+        TickType_t idleWaitTicks(void);
 
         bool rmtEstablished = false;
         esp_err_t establishRMTDriver(void);
         esp_err_t demolishRMTDriver(void);
+        esp_err_t releaseRMTDriver(void);
+        void startCommand(void);
         void startIndication(uint32_t);
-        void setAndClearColors(uint8_t, uint8_t);
+        void setAndClearColors(uint8_t, uint8_t, const uint8_t * = nullptr);
+        void transmitFrame(void);
         void resetIndication(void);
 
+        /* Indication_Timing */
+        int64_t dwellDueUs = 0; // When the current dwell step should end
+        int64_t edgeDueUs = 0;  // When the step we just finished was meant to end (0 while idle)
+        ind_jitter_t jitter = {};
+        portMUX_TYPE jitterLock = portMUX_INITIALIZER_UNLOCKED;
+#if CONFIG_WS2812_TIMING_ESP_TIMER
+        esp_timer_handle_t dwellTimer = nullptr;
+        SemaphoreHandle_t semDwell = nullptr; // Given by our timer once per step
+        bool dwellTimerRunning = false;
+
+        static void dwellTimerCallback(void *);
+#endif
+
+        void createDwellTimer(void);
+        void destroyDwellTimer(void);
+        void waitDwell(void);
+        void stopDwell(void);
+        void noteDwellError(int64_t);
+
+#if CONFIG_WS2812_STRESS_HARNESS
+        /* Indication_Stress */
+        ind_stress_t *stress = nullptr; // Only valid while a stress test is running
+        portMUX_TYPE stressLock = portMUX_INITIALIZER_UNLOCKED;
+
+        static void stressProducer(void *);
+        void stressNoteFrame(uint32_t);
+        void stressReport(ind_stress_t *);
+
+        static void isolationFiller(void *);
+
+        ind_bench_t *bench = nullptr; // Only valid while a jitter benchmark is running
+
+        static void benchLoadTask(void *);
+        static void benchTimerLoad(void *);
+        void benchNoteEdge(void);
+        void benchReport(ind_bench_t *, const ind_bench_load_t *);
+
+        bool heapCheckIdle(uint32_t);
+#endif
+
         /* Indication_Utilities */
-        std::string getStateText(LED_STATE);
+        const char *getStateText(LED_STATE);
     };
 }
@@ -7,4 +7,68 @@
 #define RMT_LED_STRIP_GPIO_NUM CONFIG_WS2812_LED_GPIO // Set the GPIO from Kconfig.  Default are provided for some DevKitC hardware
 #define RMT_LED_STRIP_RESOLUTION_HZ 10000000          // 10MHz resolution, 1 tick = 0.1us (led strip needs a high resolution)
 
+#define IND_PRIORITY_CLASSES 3     // Routine, Elevated and Alarm each own a command queue
+#define IND_CMD_WAKE 0x00000000     // Reserved command word.  Wakes the run task without starting an indication.
+
+#define IND_DWELL_US 10000      // One dwell step.  On and off times are counted in these.
+#define IND_PALETTE_SLOTS 8     // Command color nibbles 0x8 - 0xF
+#define IND_LOG_LINE_SIZE 128   // Longest formatted log line.  Built on the caller's stack, never on the heap.
+#define IND_JITTER_BUCKETS 8    // Dwell timing error histogram: <50, <100, <250, <500, <1000, <2500, <5000 and 5000uSec or more
+
+//
+// Indication program words.  The top byte is the opcode (IND_OPCODE) and the lower 24 bits are operands.
+//
+#define IND_PROG_LOOP_DEPTH 4    // Loops may nest this deep
+#define IND_PROG_STEP_BUDGET 64  // Instructions one dwell step may execute before the program is stopped
+#define IND_FADE_EASED_BIT 0x00800000
+#define IND_VERSION_PROG_WORDS 19 // Six words for each of the three version digits and an END
+
+#define IND_FADE_FRAME_PERIOD (((1000000 / IND_DWELL_US) / CONFIG_WS2812_FADE_FRAME_HZ) > 0 ? ((1000000 / IND_DWELL_US) / CONFIG_WS2812_FADE_FRAME_HZ) : 1) // Dwell steps per fade frame
+
+#define IND_OP_END() ((uint32_t)OP_End << 24)
+#define IND_OP_SET(set, clear) (((uint32_t)OP_Set << 24) | (((clear) & 0x07) << 8) | ((set) & 0x07))               // Like setAndClearColors()
+#define IND_OP_FADE(colors, level, steps) (((uint32_t)OP_Fade << 24) | (((colors) & 0x07) << 16) | (((level) & 0xFF) << 8) | ((steps) & 0xFF)) // level 255 is the set level
+#define IND_OP_FADE_EASED(colors, level, steps) (IND_OP_FADE(colors, level, steps) | IND_FADE_EASED_BIT)                                     // Slow at both ends -- good for breathing
+#define IND_OP_WAIT(steps) (((uint32_t)OP_Wait << 24) | ((steps) & 0xFFFF))                                           // Dwell steps
+#define IND_OP_LOOP(target, count) (((uint32_t)OP_Loop << 24) | (((count) & 0xFF) << 16) | ((target) & 0xFFFF))       // Go back to target count more times
+#define IND_OP_JUMP(target) (((uint32_t)OP_Jump << 24) | ((target) & 0xFFFF))
+#define IND_OP_CODE() ((uint32_t)OP_Code << 24) // The next word is a classic 32 bit indication command
+
+//
+// Pattern table layout (32 bit words).  A header, one index word per pattern and then the program words of every pattern.
+//
+#define IND_ROM_MAGIC 0x504E4449 // "INDP"
+#define IND_ROM_MAX_PATTERNS 64   // Pattern ids are 6 bits
+#define IND_ROM_HEADER(count) IND_ROM_MAGIC, (uint32_t)(count)
+#define IND_ROM_ENTRY(offset, length) ((((uint32_t)(offset) & 0xFFFF) << 16) | ((length) & 0xFFFF)) // Offset in words from the start of the table
+
+#if CONFIG_WS2812_PREEMPT_DISCARD // Start-up preemption policy from Kconfig
+#define IND_PREEMPT_DEFAULT_POLICY IND_PREEMPT::Discard
+#else
+#define IND_PREEMPT_DEFAULT_POLICY IND_PREEMPT::Resume
+#endif
+
+#if CONFIG_WS2812_CMD_QUEUE_OVERFLOW_DROP_NEWEST // Start-up command queue policy from Kconfig
+#define IND_QUE_OVERFLOW_POLICY QUE_DropNewest
+#elif CONFIG_WS2812_CMD_QUEUE_OVERFLOW_DROP_OLDEST
+#define IND_QUE_OVERFLOW_POLICY QUE_DropOldest
+#else
+#define IND_QUE_OVERFLOW_POLICY QUE_Block
+#endif
+
+#if CONFIG_WS2812_STATIC_ALLOCATION // Kernel objects live in storage we own instead of the heap.  The storage arguments vanish otherwise.
+#define IND_QUEUE_CREATE(depth, size, store, buffer) xQueueCreateStatic(depth, size, store, buffer)
+#define IND_SEMAPHORE_CREATE_BINARY(buffer) xSemaphoreCreateBinaryStatic(buffer)
+#define IND_STACK_WORDS (CONFIG_WS2812_STATIC_STACK_SIZE / sizeof(StackType_t))
+#else
+#define IND_QUEUE_CREATE(depth, size, store, buffer) xQueueCreate(depth, size)
+#define IND_SEMAPHORE_CREATE_BINARY(buffer) xSemaphoreCreateBinary()
+#endif
+
+#if CONFIG_WS2812_CMD_QUEUE_COALESCE
+#define IND_QUE_DEFAULT_POLICY (IND_QUE_OVERFLOW_POLICY | QUE_Coalesce)
+#else
+#define IND_QUE_DEFAULT_POLICY (IND_QUE_OVERFLOW_POLICY)
+#endif
+
 #define _showINDShdnSteps 0x01
\ No newline at end of file
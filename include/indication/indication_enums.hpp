@@ -1,7 +1,11 @@
 #pragma once
 
+#include <atomic>
 #include <stdint.h>
 
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
 #include "driver/rmt_types.h"
 #include "driver/rmt_tx.h"
 
@@ -19,11 +23,144 @@ typedef struct
     rmt_symbol_word_t reset_code;
 } rmt_led_strip_encoder_t;
 
+typedef struct
+{
+    uint32_t submitted;     // Commands offered to submitIndication()
+    uint32_t queued;        // Commands that reached the queue
+    uint32_t blocked;       // Block policy: sends which found the queue full and had to wait
+    uint32_t timedOut;      // Block policy: sends which waited and still failed
+    uint32_t droppedNewest; // DropNewest policy: new commands refused
+    uint32_t droppedOldest; // DropOldest policy: pending commands discarded to make room
+    uint32_t coalesced;     // Coalesce policy: commands absorbed by an identical pending command
+    uint32_t preempted;     // Running indications interrupted by a higher priority command
+    uint32_t resumed;       // Preempted indications replayed once the higher priority work finished
+    uint32_t discarded;     // Preempted indications thrown away
+    uint32_t ringDropped;   // submitIndicationFromISR() calls that found the ring full
+    uint32_t ringOverflow;  // Ring commands lost because their class queue was full
+    uint32_t scheduled;     // Commands accepted by submitIndicationAt()
+    uint32_t schedDropped;  // Scheduled commands lost because the schedule or their class queue was full
+} ind_queue_stats_t;
+
+typedef struct
+{
+    uint32_t acquired; // Times the power lock was taken
+    int64_t heldUs;    // Total time it was held, including the hold in progress
+    int64_t sinceUs;   // esp_timer time of the last reset
+    uint32_t limited;  // Frames scaled down to the current budget (CONFIG_WS2812_POWER_LIMIT)
+    bool held;
+} ind_power_stats_t;
+
+enum class IND_PRIORITY : uint8_t // Priority classes for submitted commands.  A higher class preempts a running lower class.
+{
+    Routine,
+    Elevated,
+    Alarm,
+};
+
+enum class IND_PREEMPT : uint8_t // What happens to an indication that was preempted
+{
+    Resume,  // Replay it from the start once higher priority work is finished
+    Discard, // Forget it
+};
+
+enum class IND_TICKET : uint8_t // Life of a submitted command as seen through its ticket
+{
+    Idle,
+    Queued,
+    Started,   // First frame is out
+    Preempted, // Stopped by higher priority work and waiting to be replayed
+    Finished,  // Played to the end
+    Dropped,   // Never shown (queue policy, full queue or shut down)
+    Coalesced, // Absorbed by an identical command that was already waiting
+    Discarded, // Stopped by higher priority work and not replayed
+};
+
+struct ind_ticket_t;
+typedef void (*ind_ticket_cb_t)(ind_ticket_t *ticket); // Runs in the run task (or in the submitter when the command never queued)
+
+struct ind_ticket_t // Owned by the submitter and must stay valid until a final state is reached
+{
+    ind_ticket_cb_t callback; // Optional -- called on every event
+    void *arg;                // For the callback's use
+    TaskHandle_t notifyTask;  // Optional -- receives startBits / finishBits with eSetBits
+    uint32_t startBits;
+    uint32_t finishBits; // Sent on any final state
+
+    volatile IND_TICKET state;
+    int64_t enqueueUs; // esp_timer time stamps
+    int64_t startUs;
+    int64_t finishUs;
+};
+
+enum IND_CMD_FLAGS
+{
+    CMD_Persistent = 0x01, // The command is the persistent pattern and repeats until cancelled or replaced
+    CMD_Program = 0x02,    // The value is a registered program id, not a 32 bit indication word
+    CMD_Pattern = 0x04,    // The value is a pattern table id
+    CMD_Version = 0x08,    // The start-up version flash.  Any other command ends it and it is not resumed.
+};
+
+enum IND_OPCODE // Indication program opcodes (see IND_OP_xxx() in indication_defs.hpp)
+{
+    OP_End = 0x00,
+    OP_Set = 0x01,  // Set and clear colors
+    OP_Fade = 0x02, // Ramp colors to a level over a number of dwell steps
+    OP_Wait = 0x03,
+    OP_Loop = 0x04,
+    OP_Jump = 0x05,
+    OP_Code = 0x06, // Play the classic 32 bit command held in the next word
+};
+
+typedef struct
+{
+    const uint32_t *code; // Owned by the caller and must stay valid -- const data in flash is ideal
+    uint16_t length;      // Words
+} ind_program_t;
+
+typedef struct
+{
+    uint8_t colors;    // LED_BITS being ramped
+    uint8_t eased;     // Smoothstep instead of a straight line
+    uint8_t from[3];   // A, B, C
+    uint8_t to[3];
+    uint16_t step;     // Dwell steps done
+    uint16_t steps;    // Dwell steps in the whole ramp
+    uint8_t framePeriod; // Dwell steps between frames
+    uint32_t tQ16;     // Progress through the ramp, 0 to 65536
+    uint32_t dtQ16;    // Progress added by each dwell step
+} ind_fade_t;
+
+typedef struct
+{
+    uint16_t pc;        // LOOP instruction that owns this counter
+    uint8_t remaining;  // Jumps back still to take
+} ind_prog_loop_t;
+
+typedef struct
+{
+    const uint32_t *code;
+    uint16_t length;
+    uint16_t pc;
+    uint16_t wait; // Dwell steps left in an OP_Wait
+
+    ind_prog_loop_t loop[4]; // See IND_PROG_LOOP_DEPTH
+    uint8_t loopDepth;
+} ind_prog_state_t;
+
+typedef struct
+{
+    uint32_t value; // Packed 32 bit indication word
+    IND_PRIORITY priority;
+    uint8_t flags;      // IND_CMD_FLAGS
+    ind_ticket_t *ticket; // Optional completion ticket
+} ind_cmd_t;
+
 enum class IND_NOTIFY : uint32_t // Task Notification definitions for the Run loop
 {
     NFY_SET_A_COLOR_BRIGHTNESS = 256,  // Lower byte holeds 8 bit brightness value
     NFY_SET_B_COLOR_BRIGHTNESS = 512,  //
     NFY_SET_C_COLOR_BRIGHTNESS = 1024, //
+    NFY_APPLY_SETTINGS = 2048,         // A settings block was published with setChannelSettings()
     CMD_SHUT_DOWN = 4096,              // We are slipping a command into our notification schema
 };
 
@@ -35,6 +172,15 @@ enum LED_BITS
     COLORA_Bit = 0x01,
     COLORB_Bit = 0x02,
     COLORC_Bit = 0x04,
+    COLOR_Palette_Bit = 0x08, // In a command color nibble, the lower 3 bits then pick a palette slot
+};
+
+enum IND_QUE_POLICY // Command queue overflow policies.  QUE_Coalesce may be combined with any one of the others.
+{
+    QUE_Block = 0x01,
+    QUE_DropNewest = 0x02,
+    QUE_DropOldest = 0x04,
+    QUE_Coalesce = 0x08,
 };
 
 enum LED_TRI_COLOR
@@ -56,6 +202,34 @@ enum class LED_STATE : uint8_t
     ON,
 };
 
+enum class IND_BLEND : uint8_t // How a layer combines with the layers below it
+{
+    Normal,  // Cover what is below.  Alpha below 255 lets some of it through.
+    Add,     // Add to what is below, saturating at 255
+    Lighten, // Keep the brighter of the two, channel by channel
+};
+
+typedef struct
+{
+    bool open;       // Owned by a producer
+    bool visible;    // Has a color to show
+    uint8_t priority; // Higher layers are composited later, on top
+    IND_BLEND blend;
+    uint8_t alpha;    // Normal blend only
+    uint8_t levels[3]; // A, B and C
+} ind_layer_t;
+
+typedef struct
+{
+    uint8_t levelMask; // LED_BITS of the levels below which should be applied
+    uint8_t aLevel;
+    uint8_t bLevel;
+    uint8_t cLevel;
+    LED_STATE aState; // LED_STATE::NONE leaves a state unchanged
+    LED_STATE bState;
+    LED_STATE cState;
+} ind_settings_t;
+
 enum class IND_OP : uint8_t // Primary Operations
 {
     Run,
@@ -82,12 +256,6 @@ enum class IND_INIT : uint8_t
     //EnableRMTChannel,
     Set_LED_Initial_States,
     Early_Release,
-    ColorA_On,
-    ColorA_Off,
-    ColorB_On,
-    ColorB_Off,
-    ColorC_On,
-    ColorC_Off,
     StopRMTDriver,
     Finished,
 };
@@ -99,5 +267,61 @@ enum class IND_STATES : uint8_t
     Set_FirstColor,
     Clear_SecondColor,
     Set_SecondColor,
+    Program, // Running a bytecode program
     Final,
 };
+
+typedef struct
+{
+    uint32_t sequence; // Number of snapshots published so far
+
+    IND_OP indOP;
+    IND_STATES indState;
+    bool isIndicating;
+
+    ind_cmd_t activeCmd;   // The command being shown (valid while isIndicating)
+    uint32_t persistValue; // Persistent pattern, 0 when there is none
+
+    LED_STATE aState;
+    LED_STATE bState;
+    LED_STATE cState;
+
+    uint8_t aSetLevel;
+    uint8_t bSetLevel;
+    uint8_t cSetLevel;
+
+    uint8_t aCurrValue; // The current frame
+    uint8_t bCurrValue;
+    uint8_t cCurrValue;
+} ind_snapshot_t;
+
+typedef struct
+{
+    uint32_t samples;   // Dwell steps measured
+    uint32_t bucket[8]; // Count of steps by timing error (see IND_JITTER_BUCKETS)
+    uint32_t maxUs;     // Worst timing error seen
+    int64_t totalUs;    // Sum of errors -- divide by samples for the mean
+} ind_jitter_t;
+
+typedef struct
+{
+    uint8_t tasks;         // Busy tasks to start (0 for none)
+    UBaseType_t priority;  // Their priority
+    int8_t core;           // Core to pin them to, or -1 for either core
+    uint8_t dutyPct;       // Share of each 10mSec window each busy task spins
+    uint32_t timerHz;      // Rate of a periodic esp_timer callback that spins (0 for none)
+    uint32_t timerBusyUs;  // How long that callback spins
+} ind_bench_load_t;
+
+typedef struct
+{
+    int64_t atUs;   // esp_timer time at which the command is released
+    uint32_t order; // Submission order keeps commands with the same time first in, first out
+    ind_cmd_t cmd;
+} ind_sched_t;
+
+typedef struct
+{
+    std::atomic<uint32_t> seq; // Slot sequence number.  Tells producers and the consumer whose turn the slot is.
+    ind_cmd_t cmd;
+} ind_ring_slot_t;
@@ -3,13 +3,22 @@
 /* Local Semaphores */
 SemaphoreHandle_t semIndEntry = NULL;
 
+int64_t Indication::shutdownUs = 0;
+
+static std::atomic<int> indInstances{0}; // Semaphores are shared by every instance.  The first creates them and the last destroys them.
+
+#if CONFIG_WS2812_STATIC_ALLOCATION
+static StaticSemaphore_t semIndEntryBuffer;
+static StaticSemaphore_t semIndRouteLockBuffer;
+#endif
+
 /* External Semaphores */
 extern SemaphoreHandle_t semSysEntry;
 extern SemaphoreHandle_t semNVSEntry;
 extern SemaphoreHandle_t semIndRouteLock;
 
 /* Construction / Destruction */
-Indication::Indication(uint8_t myMajorVer, uint8_t myMinorVer, uint8_t myPatchNumber)
+Indication::Indication(uint8_t myMajorVer, uint8_t myMinorVer, uint8_t myPatchNumber, int myGpio)
 {
     // Process of creating this object:
     // 1) Copy parameters into object variables.
@@ -26,6 +35,10 @@ Indication::Indication(uint8_t myMajorVer, uint8_t myMinorVer, uint8_t myPatchNu
     minorVer = myMinorVer;       //
     patchNumber = myPatchNumber; //
 
+    ledGpio = myGpio;
+    if (ledGpio != RMT_LED_STRIP_GPIO_NUM)
+        snprintf(nvsNamespace, sizeof(nvsNamespace), "indication_%d", ledGpio);
+
     if (xSemaphoreTake(semSysEntry, portMAX_DELAY)) // Get everything from the system that we need.
     {
         if (sys == nullptr)
@@ -37,15 +50,34 @@ Indication::Indication(uint8_t myMajorVer, uint8_t myMinorVer, uint8_t myPatchNu
     setLogLevels();            // Manually sets log levels for tasks down the call stack for development.
     createSemaphores();        // Creates any locking semaphores owned by this object.
     createQueues();            // We use a queue to received command requests.
+    createDwellTimer();        // Paces dwell steps when the esp_timer timing source is chosen.
+    createPowerLock();         // Held only while we indicate, so the chip may light sleep in between.
+    initIsrRing();             // Lock-free ring for commands submitted from interrupts.
     restoreVariablesFromNVS(); // Brings back all our persistant data.
+    publishSnapshot();         // Readers may look at our state before the run task starts.
 
     xSemaphoreTake(semIndEntry, portMAX_DELAY); // Take the semaphore.  This gives us a locking mechanism for initialization.
+    entryHeld = true;                           // Given back exactly once by releaseEntry().  Other objects share this semaphore.
 
     indInitStep = IND_INIT::Start; // Allow the object to initialize and then run.
     indOP = IND_OP::Init;
 
-    routeLogByValue(LOG_TYPE::INFO, std::string(__func__) + "(): runStackSizek: " + std::to_string(runStackSizeK));
-    xTaskCreate(runMarshaller, "ind_run", 1024 * runStackSizeK, this, TASK_PRIORITY_LOW, &taskHandleRun); // Low number indicates low priority task
+#if CONFIG_WS2812_SHARED_SCHEDULER
+    if (joinSharedScheduler() != ESP_OK) // The shared task runs our passes along with every other device
+        releaseEntry();
+#else
+#if CONFIG_WS2812_STATIC_ALLOCATION
+    if (claimRunTask() != ESP_OK) // A run task from static memory serves us until we are deleted
+        releaseEntry();
+#else
+    routeLogByValue(LOG_TYPE::INFO, "%s(): runStackSizek: %d", __func__, runStackSizeK);
+    if (xTaskCreate(runMarshaller, "ind_run", 1024 * runStackSizeK, this, TASK_PRIORITY_LOW, &taskHandleRun) != pdPASS) // Low number indicates low priority task
+    {
+        taskHandleRun = nullptr;
+        releaseEntry();
+    }
+#endif
+#endif
 }
 
 Indication::~Indication()
@@ -54,22 +86,29 @@ Indication::~Indication()
     // 1) Lock the object with its entry semaphore. (done by the caller)
     // 2) Send out notifications to the users of Wifi that it is shutting down. (done by caller)
     // 3) Send a task notification to CMD_SHUT_DOWN. (Looks like we are sending it to ourselves here, but this is not so...)
-    // 4) Watch the runTaskHandle and wait for it to clean up and then become nullptr.
+    // 4) Join the run task.  It gives semIndJoin as soon as its shutdown steps are finished.
     // 5) Clean up other resources created by calling task from the constructor.
     // 6) UnLock the its entry semaphore.
     // 7) Destroy all semaphores and queues at the same time. These are created by calling task in constructor.
     // 8) Done.
 
-    // The calling task can still send taskNotifications to the indication task!
-    while (!xTaskNotify(taskHandleRun, static_cast<uint32_t>(IND_NOTIFY::CMD_SHUT_DOWN), eSetValueWithoutOverwrite))
-        vTaskDelay(pdMS_TO_TICKS(50)); // Wait for the notification to be received.
-    taskYIELD();                       // One last yield to make sure Idle task can run.
+    int64_t start = esp_timer_get_time();
 
-    while (taskHandleRun != nullptr)
-        vTaskDelay(pdMS_TO_TICKS(50)); // Wait for the indication task handle to become null.
-    taskYIELD();                       // One last yield to make sure Idle task can run.
+    if (taskHandleRun != nullptr) // The calling task can still send taskNotifications to the indication task!
+    {
+        postNotify(static_cast<uint32_t>(IND_NOTIFY::CMD_SHUT_DOWN)); // Bits merge with any pending value, so this never fails
+        wakeRunTask();                                                 // Don't let an idle wait on the command queue hold us up
+        xSemaphoreTake(semIndJoin, portMAX_DELAY);                     // A playing indication is cut short at its next dwell step
+    }
+
+    shutdownUs = esp_timer_get_time() - start;
+    if (showIND & _showINDShdnSteps)
+        routeLogByValue(LOG_TYPE::INFO, "%s(): run task joined in %lld uSec", __func__, shutdownUs);
 
     xSemaphoreGive(semIndEntry);
+    destroyDwellTimer();
+    destroyPowerLock();
+    unmapPatternPartition();
     destroySemaphores();
     destroyQueues();
 }
@@ -108,17 +147,53 @@ void Indication::setLogLevels()
 
 void Indication::createSemaphores()
 {
-    semIndEntry = xSemaphoreCreateBinary(); // External access semaphore
+    semIndJoin = IND_SEMAPHORE_CREATE_BINARY(&semIndJoinBuffer); // Ours alone.  Starts empty until the run task gives it.
+
+    for (uint8_t p = 0; p < IND_PRIORITY_CLASSES; p++) // Ours alone, one per class.  An Alarm submitter never waits behind a Routine one.
+    {
+        semSubmitLock[p] = IND_SEMAPHORE_CREATE_BINARY(&semSubmitLockBuffer[p]);
+        if (semSubmitLock[p] != NULL)
+            xSemaphoreGive(semSubmitLock[p]);
+    }
+
+    if (indInstances.fetch_add(1) > 0) // Already created by another instance.  Objects may be created from several tasks.
+        return;
+
+    semIndEntry = IND_SEMAPHORE_CREATE_BINARY(&semIndEntryBuffer); // External access semaphore
     if (semIndEntry != NULL)
         xSemaphoreGive(semIndEntry);
 
-    semIndRouteLock = xSemaphoreCreateBinary();
+    semIndRouteLock = IND_SEMAPHORE_CREATE_BINARY(&semIndRouteLockBuffer);
     if (semIndRouteLock != NULL)
         xSemaphoreGive(semIndRouteLock);
 }
 
 void Indication::destroySemaphores()
 {
+    int count = 0;
+
+    if (semIndJoin != nullptr)
+    {
+        vSemaphoreDelete(semIndJoin);
+        semIndJoin = nullptr;
+    }
+
+    for (uint8_t p = 0; p < IND_PRIORITY_CLASSES; p++)
+    {
+        if (semSubmitLock[p] != nullptr)
+        {
+            vSemaphoreDelete(semSubmitLock[p]);
+            semSubmitLock[p] = nullptr;
+        }
+    }
+
+    count = indInstances.load();
+    while ((count > 0) && !indInstances.compare_exchange_weak(count, count - 1)) // Never below zero
+        ;
+
+    if (count > 1) // Other instances still use them
+        return;
+
     if (semIndEntry != nullptr)
     {
         vSemaphoreDelete(semIndEntry);
@@ -132,19 +207,50 @@ void Indication::destroySemaphores()
     }
 }
 
+void Indication::releaseEntry(void)
+{
+    // semIndEntry is shared by every object.  A second give for one take would release a lock held by another object's constructor.
+    if (entryHeld.exchange(false))
+        xSemaphoreGive(semIndEntry);
+}
+
 void Indication::createQueues()
 {
     esp_err_t ret = ESP_OK;
 
     if (queHandleIndCmdRequest == nullptr)
     {
-        queHandleIndCmdRequest = xQueueCreate(3, sizeof(uint32_t)); // Initialize the queue that holds Indication commands -- element is of size uint32_t
+        queHandleIndCmdRequest = IND_QUEUE_CREATE(CONFIG_WS2812_CMD_QUEUE_DEPTH, sizeof(uint32_t), cmdRequestQueueStore, &cmdRequestQueueBuffer); // Initialize the queue that holds Indication commands -- element is of size uint32_t
         ESP_GOTO_ON_FALSE(queHandleIndCmdRequest, ESP_ERR_NO_MEM, ind_createQueues_err, TAG, "IDF did not allocate memory for the events queue.");
     }
+
+    for (uint8_t p = 0; p < IND_PRIORITY_CLASSES; p++)
+    {
+        if (queHandleIndPriority[p] == nullptr)
+        {
+            queHandleIndPriority[p] = IND_QUEUE_CREATE(CONFIG_WS2812_CMD_QUEUE_DEPTH, sizeof(ind_cmd_t), priorityQueueStore[p], &priorityQueueBuffer[p]); // Priority class queues hold our internal command records
+            ESP_GOTO_ON_FALSE(queHandleIndPriority[p], ESP_ERR_NO_MEM, ind_createQueues_err, TAG, "IDF did not allocate memory for a priority queue.");
+        }
+    }
+
+    for (uint8_t p = 0; p < IND_PRIORITY_CLASSES; p++)
+    {
+        if (queHandleIndPattern[p] == nullptr)
+        {
+            queHandleIndPattern[p] = IND_QUEUE_CREATE(CONFIG_WS2812_PATTERN_QUEUE_DEPTH, sizeof(uint8_t), patternQueueStore[p], &patternQueueBuffer[p]); // Pattern id queues hold a single byte per entry
+            ESP_GOTO_ON_FALSE(queHandleIndPattern[p], ESP_ERR_NO_MEM, ind_createQueues_err, TAG, "IDF did not allocate memory for a pattern queue.");
+        }
+    }
+
+    if (queHandleIndSchedule == nullptr)
+    {
+        queHandleIndSchedule = IND_QUEUE_CREATE(CONFIG_WS2812_SCHEDULE_DEPTH, sizeof(ind_sched_t), scheduleQueueStore, &scheduleQueueBuffer); // Scheduled commands on their way to the run task's heap
+        ESP_GOTO_ON_FALSE(queHandleIndSchedule, ESP_ERR_NO_MEM, ind_createQueues_err, TAG, "IDF did not allocate memory for the schedule queue.");
+    }
     return;
 
 ind_createQueues_err:
-    routeLogByValue(LOG_TYPE::ERROR, std::string(__func__) + "(): error: " + esp_err_to_name(ret));
+    routeLogByValue(LOG_TYPE::ERROR, "%s(): error: %s", __func__, esp_err_to_name(ret));
 }
 
 void Indication::destroyQueues()
@@ -154,15 +260,46 @@ void Indication::destroyQueues()
         vQueueDelete(queHandleIndCmdRequest);
         queHandleIndCmdRequest = nullptr;
     }
+
+    for (uint8_t p = 0; p < IND_PRIORITY_CLASSES; p++)
+    {
+        if (queHandleIndPriority[p] != nullptr)
+        {
+            vQueueDelete(queHandleIndPriority[p]);
+            queHandleIndPriority[p] = nullptr;
+        }
+    }
+
+    for (uint8_t p = 0; p < IND_PRIORITY_CLASSES; p++)
+    {
+        if (queHandleIndPattern[p] != nullptr)
+        {
+            vQueueDelete(queHandleIndPattern[p]);
+            queHandleIndPattern[p] = nullptr;
+        }
+    }
+
+    if (queHandleIndSchedule != nullptr)
+    {
+        vQueueDelete(queHandleIndSchedule);
+        queHandleIndSchedule = nullptr;
+    }
 }
 
 /* Public Member Functions */
+#if !CONFIG_WS2812_SHARED_SCHEDULER
 TaskHandle_t &Indication::getRunTaskHandle(void)
 {
     return taskHandleRun;
 }
+#endif
 
 QueueHandle_t &Indication::getCmdRequestQueue(void)
 {
     return queHandleIndCmdRequest;
 }
+
+int64_t Indication::getShutdownLatencyUs(void)
+{
+    return shutdownUs; // From the most recent destructor.  Static, so it can be read after the object is gone.
+}
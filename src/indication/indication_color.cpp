@@ -0,0 +1,56 @@
+#include "indication/indication_.hpp"
+
+//
+// A command color nibble normally holds channel bits (COLORA_Bit, COLORB_Bit and COLORC_Bit).  With COLOR_Palette_Bit set, its
+// lower 3 bits pick one of IND_PALETTE_SLOTS palette colors instead, so 0x8 - 0xF in either color nibble shows any 24 bit color.
+//
+// Palette colors are converted to channel levels once, when they are set.  HSV goes through the hue wheel table in flash with
+// integer math only.  When a command starts, its palette colors are copied and turned into the channel bits of their non-zero
+// levels, so the frame path never looks at the palette again and channel states still apply: an OFF channel stays dark, an ON
+// channel returns to its set level when the flash ends, and AUTO channels show the palette level scaled by their set level
+// (a set level of 255 shows the palette color as it is).
+//
+
+/* Color Palette */
+esp_err_t Indication::setPaletteRGB(uint8_t slot, uint8_t red, uint8_t green, uint8_t blue)
+{
+    ESP_RETURN_ON_FALSE(slot < IND_PALETTE_SLOTS, ESP_ERR_INVALID_ARG, TAG, "palette slot must be 0 to 7");
+
+    taskENTER_CRITICAL(&settingsLock);
+    palette[slot][0] = red; // ColorA
+    palette[slot][1] = green;
+    palette[slot][2] = blue;
+    taskEXIT_CRITICAL(&settingsLock);
+    return ESP_OK;
+}
+
+esp_err_t Indication::setPaletteHSV(uint8_t slot, uint16_t hue, uint8_t sat, uint8_t val)
+{
+    uint8_t grb[3] = {};
+
+    hsvToGRB(hue, sat, val, grb);
+    return setPaletteRGB(slot, grb[1], grb[0], grb[2]);
+}
+
+uint8_t Indication::latchColorTarget(uint8_t target, uint8_t *levels, bool *usesPalette)
+{
+    uint8_t bits = 0;
+
+    *usesPalette = (target & COLOR_Palette_Bit) != 0;
+    if (!*usesPalette)
+        return target;
+
+    taskENTER_CRITICAL(&settingsLock);
+    levels[0] = palette[target & 0x07][0];
+    levels[1] = palette[target & 0x07][1];
+    levels[2] = palette[target & 0x07][2];
+    taskEXIT_CRITICAL(&settingsLock);
+
+    if (levels[0] > 0)
+        bits |= COLORA_Bit;
+    if (levels[1] > 0)
+        bits |= COLORB_Bit;
+    if (levels[2] > 0)
+        bits |= COLORC_Bit;
+    return bits;
+}
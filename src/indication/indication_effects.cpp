@@ -0,0 +1,194 @@
+#include "indication/indication_.hpp"
+
+#include <cstring> // Native Libraries
+
+//
+// Effect kernels fill or modify a whole buffer of GRB pixels (3 bytes per pixel, the order the strip takes them) in one call.
+// They are static and never touch the object, so they may be used on any buffer from any task.  All math is 8 bit or fixed
+// point, driven by two tables in flash: a raised cosine for breathing and a 256 step hue wheel that is already in GRB order.
+//
+// The inner loops are plain counted loops over bytes with no calls and no data dependent branches, so a host compiler can
+// vectorize them as they are.  Breathing only scales bytes, so it works on any pixel layout, planar buffers included.
+//
+//   effectChase()   -- every spacing-th pixel lit in color, the rest dark.  Advance offset to move it.
+//   effectRainbow() -- hues across the strip.  hue and hueStep are 8.8 fixed point turns of the wheel.
+//   effectBreathe() -- scale the buffer in place by the raised cosine at phase (0 - 255 is one breath)
+//   effectWipe()    -- paint color up to position (8.8 fixed point pixels), blending the edge pixel
+//
+
+static const uint8_t indSine8[256] = { // round((1 - cos(2 * pi * i / 256)) / 2 * 255)
+      0,   0,   0,   0,   1,   1,   1,   2,   2,   3,   4,   5,   5,   6,   7,   9,
+     10,  11,  12,  14,  15,  17,  18,  20,  21,  23,  25,  27,  29,  31,  33,  35,
+     37,  40,  42,  44,  47,  49,  52,  54,  57,  59,  62,  65,  67,  70,  73,  76,
+     79,  82,  85,  88,  90,  93,  97, 100, 103, 106, 109, 112, 115, 118, 121, 124,
+    127, 131, 134, 137, 140, 143, 146, 149, 152, 155, 158, 162, 165, 167, 170, 173,
+    176, 179, 182, 185, 188, 190, 193, 196, 198, 201, 203, 206, 208, 211, 213, 215,
+    218, 220, 222, 224, 226, 228, 230, 232, 234, 235, 237, 238, 240, 241, 243, 244,
+    245, 246, 248, 249, 250, 250, 251, 252, 253, 253, 254, 254, 254, 255, 255, 255,
+    255, 255, 255, 255, 254, 254, 254, 253, 253, 252, 251, 250, 250, 249, 248, 246,
+    245, 244, 243, 241, 240, 238, 237, 235, 234, 232, 230, 228, 226, 224, 222, 220,
+    218, 215, 213, 211, 208, 206, 203, 201, 198, 196, 193, 190, 188, 185, 182, 179,
+    176, 173, 170, 167, 165, 162, 158, 155, 152, 149, 146, 143, 140, 137, 134, 131,
+    128, 124, 121, 118, 115, 112, 109, 106, 103, 100,  97,  93,  90,  88,  85,  82,
+     79,  76,  73,  70,  67,  65,  62,  59,  57,  54,  52,  49,  47,  44,  42,  40,
+     37,  35,  33,  31,  29,  27,  25,  23,  21,  20,  18,  17,  15,  14,  12,  11,
+     10,   9,   7,   6,   5,   5,   4,   3,   2,   2,   1,   1,   1,   0,   0,   0,
+};
+
+static const uint8_t indHueGRB[256][3] = { // Full saturation and value, G R B
+    {  0, 255,   0}, {  6, 255,   0}, { 12, 255,   0}, { 18, 255,   0},
+    { 24, 255,   0}, { 30, 255,   0}, { 36, 255,   0}, { 42, 255,   0},
+    { 48, 255,   0}, { 54, 255,   0}, { 60, 255,   0}, { 66, 255,   0},
+    { 72, 255,   0}, { 78, 255,   0}, { 84, 255,   0}, { 90, 255,   0},
+    { 96, 255,   0}, {102, 255,   0}, {108, 255,   0}, {114, 255,   0},
+    {120, 255,   0}, {126, 255,   0}, {132, 255,   0}, {138, 255,   0},
+    {144, 255,   0}, {150, 255,   0}, {156, 255,   0}, {162, 255,   0},
+    {168, 255,   0}, {174, 255,   0}, {180, 255,   0}, {186, 255,   0},
+    {192, 255,   0}, {198, 255,   0}, {204, 255,   0}, {210, 255,   0},
+    {216, 255,   0}, {222, 255,   0}, {228, 255,   0}, {234, 255,   0},
+    {240, 255,   0}, {246, 255,   0}, {252, 255,   0}, {255, 253,   0},
+    {255, 247,   0}, {255, 241,   0}, {255, 235,   0}, {255, 229,   0},
+    {255, 223,   0}, {255, 217,   0}, {255, 211,   0}, {255, 205,   0},
+    {255, 199,   0}, {255, 193,   0}, {255, 187,   0}, {255, 181,   0},
+    {255, 175,   0}, {255, 169,   0}, {255, 163,   0}, {255, 157,   0},
+    {255, 151,   0}, {255, 145,   0}, {255, 139,   0}, {255, 133,   0},
+    {255, 127,   0}, {255, 121,   0}, {255, 115,   0}, {255, 109,   0},
+    {255, 103,   0}, {255,  97,   0}, {255,  91,   0}, {255,  85,   0},
+    {255,  79,   0}, {255,  73,   0}, {255,  67,   0}, {255,  61,   0},
+    {255,  55,   0}, {255,  49,   0}, {255,  43,   0}, {255,  37,   0},
+    {255,  31,   0}, {255,  25,   0}, {255,  19,   0}, {255,  13,   0},
+    {255,   7,   0}, {255,   1,   0}, {255,   0,   4}, {255,   0,  10},
+    {255,   0,  16}, {255,   0,  22}, {255,   0,  28}, {255,   0,  34},
+    {255,   0,  40}, {255,   0,  46}, {255,   0,  52}, {255,   0,  58},
+    {255,   0,  64}, {255,   0,  70}, {255,   0,  76}, {255,   0,  82},
+    {255,   0,  88}, {255,   0,  94}, {255,   0, 100}, {255,   0, 106},
+    {255,   0, 112}, {255,   0, 118}, {255,   0, 124}, {255,   0, 130},
+    {255,   0, 136}, {255,   0, 142}, {255,   0, 148}, {255,   0, 154},
+    {255,   0, 160}, {255,   0, 166}, {255,   0, 172}, {255,   0, 178},
+    {255,   0, 184}, {255,   0, 190}, {255,   0, 196}, {255,   0, 202},
+    {255,   0, 208}, {255,   0, 214}, {255,   0, 220}, {255,   0, 226},
+    {255,   0, 232}, {255,   0, 238}, {255,   0, 244}, {255,   0, 250},
+    {255,   0, 255}, {249,   0, 255}, {243,   0, 255}, {237,   0, 255},
+    {231,   0, 255}, {225,   0, 255}, {219,   0, 255}, {213,   0, 255},
+    {207,   0, 255}, {201,   0, 255}, {195,   0, 255}, {189,   0, 255},
+    {183,   0, 255}, {177,   0, 255}, {171,   0, 255}, {165,   0, 255},
+    {159,   0, 255}, {153,   0, 255}, {147,   0, 255}, {141,   0, 255},
+    {135,   0, 255}, {129,   0, 255}, {123,   0, 255}, {117,   0, 255},
+    {111,   0, 255}, {105,   0, 255}, { 99,   0, 255}, { 93,   0, 255},
+    { 87,   0, 255}, { 81,   0, 255}, { 75,   0, 255}, { 69,   0, 255},
+    { 63,   0, 255}, { 57,   0, 255}, { 51,   0, 255}, { 45,   0, 255},
+    { 39,   0, 255}, { 33,   0, 255}, { 27,   0, 255}, { 21,   0, 255},
+    { 15,   0, 255}, {  9,   0, 255}, {  3,   0, 255}, {  0,   2, 255},
+    {  0,   8, 255}, {  0,  14, 255}, {  0,  20, 255}, {  0,  26, 255},
+    {  0,  32, 255}, {  0,  38, 255}, {  0,  44, 255}, {  0,  50, 255},
+    {  0,  56, 255}, {  0,  62, 255}, {  0,  68, 255}, {  0,  74, 255},
+    {  0,  80, 255}, {  0,  86, 255}, {  0,  92, 255}, {  0,  98, 255},
+    {  0, 104, 255}, {  0, 110, 255}, {  0, 116, 255}, {  0, 122, 255},
+    {  0, 128, 255}, {  0, 134, 255}, {  0, 140, 255}, {  0, 146, 255},
+    {  0, 152, 255}, {  0, 158, 255}, {  0, 164, 255}, {  0, 170, 255},
+    {  0, 176, 255}, {  0, 182, 255}, {  0, 188, 255}, {  0, 194, 255},
+    {  0, 200, 255}, {  0, 206, 255}, {  0, 212, 255}, {  0, 218, 255},
+    {  0, 224, 255}, {  0, 230, 255}, {  0, 236, 255}, {  0, 242, 255},
+    {  0, 248, 255}, {  0, 254, 255}, {  0, 255, 251}, {  0, 255, 245},
+    {  0, 255, 239}, {  0, 255, 233}, {  0, 255, 227}, {  0, 255, 221},
+    {  0, 255, 215}, {  0, 255, 209}, {  0, 255, 203}, {  0, 255, 197},
+    {  0, 255, 191}, {  0, 255, 185}, {  0, 255, 179}, {  0, 255, 173},
+    {  0, 255, 167}, {  0, 255, 161}, {  0, 255, 155}, {  0, 255, 149},
+    {  0, 255, 143}, {  0, 255, 137}, {  0, 255, 131}, {  0, 255, 125},
+    {  0, 255, 119}, {  0, 255, 113}, {  0, 255, 107}, {  0, 255, 101},
+    {  0, 255,  95}, {  0, 255,  89}, {  0, 255,  83}, {  0, 255,  77},
+    {  0, 255,  71}, {  0, 255,  65}, {  0, 255,  59}, {  0, 255,  53},
+    {  0, 255,  47}, {  0, 255,  41}, {  0, 255,  35}, {  0, 255,  29},
+    {  0, 255,  23}, {  0, 255,  17}, {  0, 255,  11}, {  0, 255,   5},
+};
+
+/* Effect Kernels */
+void Indication::effectChase(uint8_t *grb, uint16_t pixels, const uint8_t *color, uint8_t spacing, uint16_t offset)
+{
+    uint16_t first = 0;
+
+    if ((grb == nullptr) || (color == nullptr) || (spacing == 0))
+        return;
+
+    memset(grb, 0, pixels * 3);
+    first = (spacing - (offset % spacing)) % spacing; // The first pixel where (i + offset) is a multiple of spacing
+
+    for (uint32_t i = first; i < pixels; i += spacing)
+    {
+        grb[(i * 3) + 0] = color[0];
+        grb[(i * 3) + 1] = color[1];
+        grb[(i * 3) + 2] = color[2];
+    }
+}
+
+void Indication::effectRainbow(uint8_t *grb, uint16_t pixels, uint16_t hue, uint16_t hueStep)
+{
+    if (grb == nullptr)
+        return;
+
+    for (uint32_t i = 0; i < pixels; i++)
+    {
+        const uint8_t *c = indHueGRB[(uint16_t)(hue + (i * hueStep)) >> 8]; // The hue wraps around the wheel in 16 bits
+
+        grb[(i * 3) + 0] = c[0];
+        grb[(i * 3) + 1] = c[1];
+        grb[(i * 3) + 2] = c[2];
+    }
+}
+
+void Indication::effectBreathe(uint8_t *grb, uint16_t pixels, uint8_t phase)
+{
+    uint16_t scale = indSine8[phase] + 1; // 1 - 256 so that the top of a breath leaves the buffer as it was
+    uint32_t bytes = pixels * 3;
+
+    if (grb == nullptr)
+        return;
+
+    for (uint32_t i = 0; i < bytes; i++)
+        grb[i] = (grb[i] * scale) >> 8;
+}
+
+void Indication::effectWipe(uint8_t *grb, uint16_t pixels, const uint8_t *color, uint32_t position)
+{
+    uint32_t whole = position >> 8;
+    uint16_t frac = position & 0xFF;
+
+    if ((grb == nullptr) || (color == nullptr))
+        return;
+
+    if (whole > pixels)
+        whole = pixels;
+
+    for (uint32_t i = 0; i < whole; i++)
+    {
+        grb[(i * 3) + 0] = color[0];
+        grb[(i * 3) + 1] = color[1];
+        grb[(i * 3) + 2] = color[2];
+    }
+
+    if ((whole < pixels) && (frac > 0)) // The edge pixel is part way between what it was and color
+    {
+        for (uint8_t c = 0; c < 3; c++)
+            grb[(whole * 3) + c] += (int16_t)(((color[c] - grb[(whole * 3) + c]) * frac) >> 8);
+    }
+}
+
+/* Color Conversion */
+void Indication::hsvToGRB(uint16_t hue, uint8_t sat, uint8_t val, uint8_t *grb)
+{
+    // hue is a full turn in 16 bits.  Neighbouring wheel entries are blended by the low byte, so hues are not limited to 256 steps.
+    const uint8_t *lo = indHueGRB[hue >> 8];
+    const uint8_t *hi = indHueGRB[((hue >> 8) + 1) & 0xFF];
+    uint16_t frac = hue & 0xFF;
+
+    if (grb == nullptr)
+        return;
+
+    for (uint8_t c = 0; c < 3; c++)
+    {
+        uint16_t full = lo[c] + (((hi[c] - lo[c]) * (int16_t)frac) >> 8); // Full saturation and value
+        uint16_t pale = 255 - (((255 - full) * sat) / 255);               // Saturation pulls toward white
+
+        grb[c] = (pale * val) / 255;
+    }
+}
@@ -0,0 +1,84 @@
+#include "indication/indication_.hpp"
+
+//
+// The fade engine ramps channels between two keyframes -- where they are now and a target level -- over a number of dwell
+// steps.  All arithmetic is integer.  Progress is a Q16 fraction (65536 is the end of the ramp) and the only division happens
+// once when a ramp starts.  Each step adds a fixed increment, so the work per frame is a few multiplies for three channels.
+//
+// Frames are sent every IND_FADE_FRAME_PERIOD steps (CONFIG_WS2812_FADE_FRAME_HZ) and always on the last step, so a ramp ends
+// exactly on its target at any frame rate.  An eased ramp follows smoothstep (3t^2 - 2t^3), which starts and ends gently
+// and makes a natural breathing effect when ramps go up and down in a loop.
+//
+// Channel states still rule: an OFF channel stays dark and an ON channel holds its set level (see fadeLevel()).
+//
+
+/* Fade Engine */
+void Indication::startFade(uint8_t colors, uint8_t level, uint16_t steps, bool eased)
+{
+    fade.colors = colors;
+    fade.eased = eased;
+
+    fade.from[0] = aCurrValue;
+    fade.from[1] = bCurrValue;
+    fade.from[2] = cCurrValue;
+
+    fade.to[0] = fadeLevel(aState, aSetLevel, level);
+    fade.to[1] = fadeLevel(bState, bSetLevel, level);
+    fade.to[2] = fadeLevel(cState, cSetLevel, level);
+
+    fade.step = 0;
+    fade.steps = (steps > 0) ? steps : 1;
+    fade.framePeriod = IND_FADE_FRAME_PERIOD;
+    fade.tQ16 = 0;
+    fade.dtQ16 = (65536 + (fade.steps / 2)) / fade.steps;
+
+    fadeTick(); // The first step happens now
+}
+
+bool Indication::isFading(void)
+{
+    return fade.step < fade.steps;
+}
+
+void Indication::fadeTick(void)
+{
+    uint8_t *value[3] = {&aCurrValue, &bCurrValue, &cCurrValue};
+    uint32_t e = 0;
+
+    if (!isFading())
+        return;
+
+    fade.step++;
+
+    if (fade.step >= fade.steps)
+        fade.tQ16 = 65536; // Land exactly on the target whatever rounding did on the way
+    else
+        fade.tQ16 += fade.dtQ16;
+
+    if ((fade.step < fade.steps) && ((fade.step % fade.framePeriod) != 0))
+        return; // Not a frame step
+
+    e = fade.tQ16;
+    if (fade.eased)
+    {
+        uint32_t t2 = (uint32_t)(((uint64_t)e * e) >> 16);              // t reaches 65536, so its square needs more than 32 bits
+        e = (uint32_t)(((uint64_t)t2 * ((3 * 65536) - (2 * e))) >> 16); // t^2 (3 - 2t)
+    }
+
+    for (uint8_t ch = 0; ch < 3; ch++)
+    {
+        if (fade.colors & (1 << ch))
+            *value[ch] = fade.from[ch] + (((((int32_t)fade.to[ch] - fade.from[ch]) * (int32_t)e) + 32768) >> 16);
+    }
+
+    transmitFrame();
+}
+
+uint8_t Indication::fadeLevel(LED_STATE state, uint8_t setLevel, uint8_t level)
+{
+    if (state == LED_STATE::OFF)
+        return 0;
+    if (state == LED_STATE::ON) // An ON channel holds its set level, just as it does for classic commands
+        return setLevel;
+    return ((uint16_t)setLevel * level + 127) / 255;
+}
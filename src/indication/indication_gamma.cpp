@@ -0,0 +1,97 @@
+#include "indication/indication_.hpp"
+
+//
+// Levels are perceived on a curve, not a line, so the bottom of the 8 bit range moves in big visible jumps.  With
+// CONFIG_WS2812_GAMMA, every level passes through a gamma 2.2 table on its way out.  The table holds 8.8 fixed-point values,
+// so a level keeps its fraction of a drive step.  Nothing is computed per frame -- it is one table lookup per channel.
+//
+// Without dithering the fraction is dropped, but a non-zero level never becomes dark.  With CONFIG_WS2812_DITHER the fraction
+// (CONFIG_WS2812_DITHER_BITS of it) is carried from frame to frame, so over a few frames the LED averages a level between two
+// drive steps.  Frames are refreshed every dwell step while any channel has a fraction, which also keeps the RMT driver
+// established while idle.  Fewer fraction bits give shorter dither cycles and less chance of visible flicker.
+//
+#if CONFIG_WS2812_GAMMA
+
+static const uint16_t indGammaQ8[256] = { // round(255 * (level / 255)^2.2 * 256)
+        0,     0,     2,     4,     7,    11,    17,    24,    32,    42,    53,    65,
+       78,    94,   110,   128,   148,   169,   191,   216,   241,   269,   298,   328,
+      360,   394,   430,   467,   506,   547,   589,   633,   679,   726,   776,   827,
+      880,   934,   991,  1049,  1109,  1171,  1235,  1300,  1368,  1437,  1508,  1581,
+     1656,  1733,  1812,  1893,  1975,  2060,  2146,  2235,  2325,  2417,  2512,  2608,
+     2706,  2806,  2908,  3013,  3119,  3227,  3337,  3450,  3564,  3680,  3798,  3919,
+     4041,  4166,  4292,  4421,  4552,  4685,  4819,  4956,  5096,  5237,  5380,  5525,
+     5673,  5823,  5974,  6128,  6284,  6442,  6603,  6765,  6930,  7097,  7266,  7437,
+     7610,  7786,  7963,  8143,  8325,  8509,  8696,  8885,  9075,  9268,  9464,  9661,
+     9861, 10063, 10267, 10474, 10682, 10893, 11107, 11322, 11540, 11760, 11982, 12207,
+    12433, 12663, 12894, 13128, 13363, 13602, 13842, 14085, 14330, 14578, 14827, 15080,
+    15334, 15591, 15850, 16111, 16375, 16641, 16909, 17180, 17453, 17729, 18006, 18287,
+    18569, 18854, 19141, 19431, 19723, 20017, 20314, 20613, 20915, 21218, 21525, 21833,
+    22144, 22458, 22774, 23092, 23413, 23736, 24062, 24390, 24720, 25053, 25388, 25726,
+    26066, 26408, 26753, 27101, 27451, 27803, 28158, 28515, 28875, 29237, 29602, 29969,
+    30338, 30710, 31085, 31462, 31841, 32223, 32608, 32995, 33384, 33776, 34170, 34567,
+    34967, 35369, 35773, 36180, 36589, 37001, 37416, 37833, 38252, 38674, 39099, 39526,
+    39956, 40388, 40823, 41260, 41700, 42142, 42587, 43034, 43484, 43937, 44392, 44849,
+    45310, 45772, 46238, 46706, 47176, 47649, 48125, 48603, 49084, 49567, 50053, 50542,
+    51033, 51526, 52023, 52522, 53023, 53527, 54034, 54543, 55055, 55570, 56087, 56607,
+    57129, 57654, 58182, 58712, 59245, 59780, 60318, 60859, 61402, 61948, 62497, 63048,
+    63602, 64159, 64718, 65280,
+};
+
+#if CONFIG_WS2812_DITHER
+#define IND_DITHER_MASK ((uint16_t)(0xFF00 | (0xFF << (8 - CONFIG_WS2812_DITHER_BITS)))) // Keep the whole part and the fraction bits we dither
+#endif
+
+/* Gamma and Dithering */
+uint8_t Indication::outputLevel(uint8_t ch, uint8_t value)
+{
+    uint16_t q = indGammaQ8[value];
+
+#if CONFIG_WS2812_DITHER
+    uint16_t acc = 0;
+
+    q &= IND_DITHER_MASK;
+    if ((value > 0) && (q == 0))
+        q = 0x0100 >> CONFIG_WS2812_DITHER_BITS; // The smallest fraction we can show
+
+    if ((q & 0x00FF) == 0)
+        return q >> 8; // A whole drive step needs no dithering
+
+    ditherPending = true;
+    acc = ditherAcc[ch] + (q & 0x00FF);
+    ditherAcc[ch] = acc & 0x00FF;
+    return (q >> 8) + (acc >> 8); // The fraction carries into a whole step now and then.  The top entry is whole, so this never overflows.
+#else
+    if ((value > 0) && (q < 0x0100))
+        return 1; // Dim, but never dark
+    return q >> 8;
+#endif
+}
+
+#if CONFIG_WS2812_DITHER
+void Indication::refreshDither(void)
+{
+    esp_err_t ret = ESP_OK;
+
+    if (!ditherPending)
+        return;
+
+    if (!rmtEstablished)
+        ESP_GOTO_ON_ERROR(establishRMTDriver(), ind_refreshDither_err, TAG, "establishRMTDriver() failed");
+
+    transmitFrame();
+    return;
+
+ind_refreshDither_err:
+    errFunc = __func__;
+    errCode = ret;
+    indOP = IND_OP::Error;
+}
+#endif
+
+#endif
+
+bool Indication::isDriverHeld(void)
+{
+    // The driver stays up between commands for a persistent pattern, or to keep dithered levels refreshed
+    return (persistValue != IND_CMD_WAKE) || ditherPending;
+}
@@ -0,0 +1,170 @@
+#include "indication/indication_.hpp"
+
+//
+// Layers let several subsystems share the LED without fighting over it.  Each producer opens its own layer once, with a
+// priority and a blend mode, and after that only changes its own color.  A color that did not change costs nothing -- the run
+// task is not woken and nothing is queued -- so producers no longer need to keep re-sending their status to stay on the LED.
+//
+// While no indication is showing, the run task composites the visible layers from the lowest priority up and sends one frame.
+// It does this only when a layer changed, or after an indication covered the layers.  Indications are still the way to flash
+// the LED and they always show on their own.  A persistent pattern owns the LED until it is cancelled.  Channel states still
+// apply to the composite: an OFF channel stays dark and an ON channel never drops below its set level.
+//
+
+/* Layer Ownership */
+esp_err_t Indication::openLayer(uint8_t priority, IND_BLEND blend, uint8_t *id)
+{
+    esp_err_t ret = ESP_ERR_NO_MEM;
+
+    ESP_RETURN_ON_FALSE(id, ESP_ERR_INVALID_ARG, TAG, "id can not be null...");
+    ESP_RETURN_ON_FALSE(blend <= IND_BLEND::Lighten, ESP_ERR_INVALID_ARG, TAG, "unknown blend mode");
+
+    taskENTER_CRITICAL(&layerLock);
+    for (uint8_t i = 0; i < CONFIG_WS2812_LAYERS; i++)
+    {
+        if (!layers[i].open)
+        {
+            layers[i] = {true, false, priority, blend, 255, {}};
+            *id = i;
+            ret = ESP_OK;
+            break;
+        }
+    }
+    taskEXIT_CRITICAL(&layerLock);
+
+    ESP_RETURN_ON_ERROR(ret, TAG, "no free layer");
+    return ESP_OK;
+}
+
+esp_err_t Indication::setLayer(uint8_t id, uint8_t red, uint8_t green, uint8_t blue, uint8_t alpha)
+{
+    ind_layer_t layer = {true, true, 0, IND_BLEND::Normal, alpha, {red, green, blue}};
+    return changeLayer(id, &layer);
+}
+
+esp_err_t Indication::hideLayer(uint8_t id)
+{
+    ind_layer_t layer = {true, false, 0, IND_BLEND::Normal, 255, {}};
+    return changeLayer(id, &layer);
+}
+
+esp_err_t Indication::closeLayer(uint8_t id)
+{
+    ESP_RETURN_ON_ERROR(hideLayer(id), TAG, "hideLayer() failed");
+
+    taskENTER_CRITICAL(&layerLock);
+    layers[id].open = false;
+    taskEXIT_CRITICAL(&layerLock);
+    return ESP_OK;
+}
+
+esp_err_t Indication::changeLayer(uint8_t id, const ind_layer_t *layer)
+{
+    bool changed = false;
+
+    ESP_RETURN_ON_FALSE(id < CONFIG_WS2812_LAYERS, ESP_ERR_INVALID_ARG, TAG, "layer id is not valid");
+
+    taskENTER_CRITICAL(&layerLock);
+    if (layers[id].open)
+    {
+        ind_layer_t *l = &layers[id];
+
+        changed = (l->visible != layer->visible) || (layer->visible && ((l->alpha != layer->alpha) || (l->levels[0] != layer->levels[0]) ||
+                                                                        (l->levels[1] != layer->levels[1]) || (l->levels[2] != layer->levels[2])));
+        l->visible = layer->visible;
+        l->alpha = layer->alpha;
+        l->levels[0] = layer->levels[0];
+        l->levels[1] = layer->levels[1];
+        l->levels[2] = layer->levels[2];
+
+        if (changed)
+            layersDirty = true;
+    }
+    else
+        id = CONFIG_WS2812_LAYERS; // Not ours to change
+    taskEXIT_CRITICAL(&layerLock);
+
+    ESP_RETURN_ON_FALSE(id < CONFIG_WS2812_LAYERS, ESP_ERR_INVALID_STATE, TAG, "layer is not open");
+
+    if (changed)
+        wakeRunTask();
+    return ESP_OK;
+}
+
+/* Compositing */
+void Indication::compositeLayers(void)
+{
+    esp_err_t ret = ESP_OK;
+    ind_layer_t stack[CONFIG_WS2812_LAYERS];
+    uint8_t count = 0;
+    uint8_t out[3] = {};
+    bool dirty = false;
+
+    if (IsIndicating || (persistValue != IND_CMD_WAKE)) // Indications and persistent patterns own the LED
+        return;
+
+    taskENTER_CRITICAL(&layerLock);
+    dirty = layersDirty;
+    layersDirty = false;
+    for (uint8_t i = 0; i < CONFIG_WS2812_LAYERS; i++)
+    {
+        if (layers[i].open && layers[i].visible)
+            stack[count++] = layers[i];
+    }
+    taskEXIT_CRITICAL(&layerLock);
+
+    if (!dirty && (compositeShown || (count == 0))) // Nothing new, or an indication left the LED dark with nothing to put back
+        return;
+
+    for (uint8_t i = 1; i < count; i++) // Insertion sort on priority.  Equal priorities keep their layer order.
+    {
+        ind_layer_t layer = stack[i];
+        uint8_t j = i;
+
+        for (; (j > 0) && (stack[j - 1].priority > layer.priority); j--)
+            stack[j] = stack[j - 1];
+        stack[j] = layer;
+    }
+
+    for (uint8_t i = 0; i < count; i++)
+    {
+        for (uint8_t c = 0; c < 3; c++)
+        {
+            uint16_t top = stack[i].levels[c];
+
+            switch (stack[i].blend)
+            {
+            case IND_BLEND::Add:
+                out[c] = (out[c] + top > 255) ? 255 : out[c] + top;
+                break;
+
+            case IND_BLEND::Lighten:
+                out[c] = (top > out[c]) ? top : out[c];
+                break;
+
+            default: // IND_BLEND::Normal
+                out[c] = ((top * stack[i].alpha) + (out[c] * (255 - stack[i].alpha))) / 255;
+                break;
+            }
+        }
+    }
+
+    aCurrValue = (aState == LED_STATE::OFF) ? 0 : ((aState == LED_STATE::ON) && (out[0] < aSetLevel)) ? aSetLevel : out[0];
+    bCurrValue = (bState == LED_STATE::OFF) ? 0 : ((bState == LED_STATE::ON) && (out[1] < bSetLevel)) ? bSetLevel : out[1];
+    cCurrValue = (cState == LED_STATE::OFF) ? 0 : ((cState == LED_STATE::ON) && (out[2] < cSetLevel)) ? cSetLevel : out[2];
+
+    if (!rmtEstablished)
+        ESP_GOTO_ON_ERROR(establishRMTDriver(), ind_compositeLayers_err, TAG, "establishRMTDriver() failed");
+
+    transmitFrame();
+    compositeShown = true;
+
+    if (!isDriverHeld()) // The LED keeps the frame on its own
+        ESP_GOTO_ON_ERROR(demolishRMTDriver(), ind_compositeLayers_err, TAG, "demolishRMTDriver() failed");
+    return;
+
+ind_compositeLayers_err:
+    errFunc = __func__;
+    errCode = ret;
+    indOP = IND_OP::Error;
+}
@@ -13,7 +13,9 @@ esp_err_t Indication::rmt_del_led_strip_encoder(rmt_encoder_t *encoder)
     rmt_led_strip_encoder_t *led_encoder = __containerof(encoder, rmt_led_strip_encoder_t, base);
     ESP_RETURN_ON_ERROR(rmt_del_encoder(led_encoder->bytes_encoder), "_ind", "rmt_del_encoder() failed.");
     ESP_RETURN_ON_ERROR(rmt_del_encoder(led_encoder->copy_encoder), "_ind", "rmt_del_encoder() failed.");
-    free(led_encoder);
+#if !CONFIG_WS2812_STATIC_ALLOCATION
+    free(led_encoder); // Otherwise it is storage inside our object
+#endif
     return ESP_OK;
 }
 
@@ -80,7 +82,12 @@ esp_err_t Indication::rmt_new_led_strip_encoder(const led_strip_encoder_config_t
     ESP_RETURN_ON_FALSE(config, ESP_FAIL, TAG, "config encoder parameter can not be null...");
     ESP_RETURN_ON_FALSE(ret_encoder, ESP_FAIL, TAG, "ret_encoder handle parameter can not be null...");
 
+#if CONFIG_WS2812_STATIC_ALLOCATION
+    rmt_led_strip_encoder_t *led_encoder = &ledEncoderStore;
+    *led_encoder = {};
+#else
     rmt_led_strip_encoder_t *led_encoder = (rmt_led_strip_encoder_t *)calloc(1, sizeof(rmt_led_strip_encoder_t));
+#endif
 
     ESP_RETURN_ON_FALSE(led_encoder, ESP_FAIL, TAG, "Memory for rmt_led_strip_encoder_t allocation failed...");
 
@@ -109,7 +116,7 @@ esp_err_t Indication::rmt_new_led_strip_encoder(const led_strip_encoder_config_t
 
     if (ret != ESP_OK)
     {
-        routeLogByValue(LOG_TYPE::ERROR, std::string(__func__) + "(): rmt_new_copy_encoder() Failed: err = " + std::string(esp_err_to_name(ret)));
+        routeLogByValue(LOG_TYPE::ERROR, "%s(): rmt_new_copy_encoder() Failed: err = %s", __func__, esp_err_to_name(ret));
 
         if (led_encoder->bytes_encoder) // Clean up the encoder from previous area
             rmt_del_encoder(led_encoder->bytes_encoder);
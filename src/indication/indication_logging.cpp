@@ -11,33 +11,31 @@
 SemaphoreHandle_t semIndRouteLock = NULL;
 
 /* Logging */
-// Logging by reference potentially allows a better algorithm for accessing large data throught a pointer.
-void Indication::routeLogByRef(LOG_TYPE _type, std::string *_msg)
+// Logging by reference routes a finished message.  The caller keeps ownership of the text.
+void Indication::routeLogByRef(LOG_TYPE _type, const char *_msg)
 {
-    routeLogByValue(_type, *_msg); // Make a copy and see if this will work for all use cases where the msg is large.
-
     if (xSemaphoreTake(semIndRouteLock, portMAX_DELAY)) // We use this lock to prevent sys_evt and ind_run tasks from having conflicts
     {
         LOG_TYPE type = _type;   // Copy our parameters upon entry before they are over-written by another calling task.
-        std::string *msg = _msg; // This will point back to the caller's variable.
+        const char *msg = _msg; // This will point back to the caller's text.
 
         switch (type)
         {
         case LOG_TYPE::ERROR:
         {
-            ESP_LOGE(TAG, "%s", (*msg).c_str()); // Print out our errors here so we see it in the console.
+            ESP_LOGE(TAG, "%s", msg); // Print out our errors here so we see it in the console.
             break;
         }
 
         case LOG_TYPE::WARN:
         {
-            ESP_LOGW(TAG, "%s", (*msg).c_str()); // Print out our warning here so we see it in the console.
+            ESP_LOGW(TAG, "%s", msg); // Print out our warning here so we see it in the console.
             break;
         }
 
         case LOG_TYPE::INFO:
         {
-            ESP_LOGI(TAG, "%s", (*msg).c_str()); // Print out our information here so we see it in the console.
+            ESP_LOGI(TAG, "%s", msg); // Print out our information here so we see it in the console.
             break;
         }
         }
@@ -46,34 +44,15 @@ void Indication::routeLogByRef(LOG_TYPE _type, std::string *_msg)
     }
 }
 
-void Indication::routeLogByValue(LOG_TYPE _type, std::string _msg)
+// Logging by value formats printf style into a fixed line on our own stack, so no log line ever touches the heap.  Long lines are cut short.
+void Indication::routeLogByValue(LOG_TYPE _type, const char *_format, ...)
 {
-    if (xSemaphoreTake(semIndRouteLock, portMAX_DELAY)) // We use this lock to prevent sys_evt and ind_run tasks from having conflicts
-    {
-        LOG_TYPE type = _type; // Copy our parameters upon entry before they are over-written by another calling task.
-        std::string msg = _msg;
-
-        switch (type)
-        {
-        case LOG_TYPE::ERROR:
-        {
-            ESP_LOGE(TAG, "%s", (msg).c_str()); // Print out our errors here so we see it in the console.
-            break;
-        }
-
-        case LOG_TYPE::WARN:
-        {
-            ESP_LOGW(TAG, "%s", (msg).c_str()); // Print out our warning here so we see it in the console.
-            break;
-        }
+    char msg[IND_LOG_LINE_SIZE];
+    va_list args;
 
-        case LOG_TYPE::INFO:
-        {
-            ESP_LOGI(TAG, "%s", (msg).c_str()); // Print out our information here so we see it in the console.
-            break;
-        }
-        }
+    va_start(args, _format);
+    vsnprintf(msg, sizeof(msg), _format, args);
+    va_end(args);
 
-        xSemaphoreGive(semIndRouteLock);
-    }
+    routeLogByRef(_type, msg);
 }
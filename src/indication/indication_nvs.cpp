@@ -18,10 +18,10 @@ void Indication::restoreVariablesFromNVS(void)
         nvs = NVS::getInstance(); // First, get the nvs object handle if didn't already.
 
     if (xSemaphoreTake(semNVSEntry, portMAX_DELAY))
-        ESP_GOTO_ON_ERROR(nvs->openNVSStorage("indication"), ind_restoreVariablesFromNVS_err, TAG, "nvs->openNVSStorage('indication') failed");
+        ESP_GOTO_ON_ERROR(nvs->openNVSStorage(nvsNamespace), ind_restoreVariablesFromNVS_err, TAG, "nvs->openNVSStorage('%s') failed", nvsNamespace);
 
     if (show & _showNVS)
-        routeLogByValue(LOG_TYPE::INFO, std::string(__func__) + "(): indication namespace start");
+        routeLogByValue(LOG_TYPE::INFO, "%s(): indication namespace start", __func__);
 
     if (successFlag) // Restore runStackSizeK
     {
@@ -37,13 +37,13 @@ void Indication::restoreVariablesFromNVS(void)
             }
 
             if (show & _showNVS)
-                routeLogByValue(LOG_TYPE::INFO, std::string(__func__) + "(): runStackSizeK       is " + std::to_string(runStackSizeK));
+                routeLogByValue(LOG_TYPE::INFO, "%s(): runStackSizeK       is %d", __func__, runStackSizeK);
         }
 
         if (ret != ESP_OK)
         {
             successFlag = false;
-            routeLogByValue(LOG_TYPE::ERROR, std::string(__func__) + "(): Error, Unable to restore runStackSizeK");
+            routeLogByValue(LOG_TYPE::ERROR, "%s(): Error, Unable to restore runStackSizeK", __func__);
         }
     }
 
@@ -52,12 +52,12 @@ void Indication::restoreVariablesFromNVS(void)
         if (nvs->readU8IntegerFromNVS("aState", (uint8_t *)&aState) == ESP_OK)
         {
             if (show & _showNVS)
-                routeLogByValue(LOG_TYPE::INFO, std::string(__func__) + "(): aState              is " + getStateText(aState));
+                routeLogByValue(LOG_TYPE::INFO, "%s(): aState              is %s", __func__, getStateText(aState));
         }
         else
         {
             successFlag = false;
-            routeLogByValue(LOG_TYPE::ERROR, std::string(__func__) + "(): Error, Unable to restore aState");
+            routeLogByValue(LOG_TYPE::ERROR, "%s(): Error, Unable to restore aState", __func__);
         }
     }
 
@@ -66,12 +66,12 @@ void Indication::restoreVariablesFromNVS(void)
         if (nvs->readU8IntegerFromNVS("bState", (uint8_t *)&bState) == ESP_OK)
         {
             if (show & _showNVS)
-                routeLogByValue(LOG_TYPE::INFO, std::string(__func__) + "(): bState              is " + getStateText(bState));
+                routeLogByValue(LOG_TYPE::INFO, "%s(): bState              is %s", __func__, getStateText(bState));
         }
         else
         {
             successFlag = false;
-            routeLogByValue(LOG_TYPE::ERROR, std::string(__func__) + "(): Error, Unable to restore bState");
+            routeLogByValue(LOG_TYPE::ERROR, "%s(): Error, Unable to restore bState", __func__);
         }
     }
 
@@ -80,12 +80,12 @@ void Indication::restoreVariablesFromNVS(void)
         if (nvs->readU8IntegerFromNVS("cState", (uint8_t *)&cState) == ESP_OK)
         {
             if (show & _showNVS)
-                routeLogByValue(LOG_TYPE::INFO, std::string(__func__) + "(): cState              is " + getStateText(cState));
+                routeLogByValue(LOG_TYPE::INFO, "%s(): cState              is %s", __func__, getStateText(cState));
         }
         else
         {
             successFlag = false;
-            routeLogByValue(LOG_TYPE::ERROR, std::string(__func__) + "(): Error, Unable to restore cState");
+            routeLogByValue(LOG_TYPE::ERROR, "%s(): Error, Unable to restore cState", __func__);
         }
     }
 
@@ -105,13 +105,13 @@ void Indication::restoreVariablesFromNVS(void)
             }
 
             if (show & _showNVS)
-                routeLogByValue(LOG_TYPE::INFO, std::string(__func__) + "(): aSetLevel           is " + std::to_string(aSetLevel));
+                routeLogByValue(LOG_TYPE::INFO, "%s(): aSetLevel           is %d", __func__, aSetLevel);
         }
 
         if (ret != ESP_OK)
         {
             successFlag = false;
-            routeLogByValue(LOG_TYPE::ERROR, std::string(__func__) + "(): Error, Unable to restore aSetLevel");
+            routeLogByValue(LOG_TYPE::ERROR, "%s(): Error, Unable to restore aSetLevel", __func__);
         }
     }
 
@@ -131,13 +131,13 @@ void Indication::restoreVariablesFromNVS(void)
             }
 
             if (show & _showNVS)
-                routeLogByValue(LOG_TYPE::INFO, std::string(__func__) + "(): bSetLevel           is " + std::to_string(bSetLevel));
+                routeLogByValue(LOG_TYPE::INFO, "%s(): bSetLevel           is %d", __func__, bSetLevel);
         }
 
         if (ret != ESP_OK)
         {
             successFlag = false;
-            routeLogByValue(LOG_TYPE::ERROR, std::string(__func__) + "(): Error, Unable to restore bSetLevel");
+            routeLogByValue(LOG_TYPE::ERROR, "%s(): Error, Unable to restore bSetLevel", __func__);
         }
     }
 
@@ -157,33 +157,33 @@ void Indication::restoreVariablesFromNVS(void)
             }
 
             if (show & _showNVS)
-                routeLogByValue(LOG_TYPE::INFO, std::string(__func__) + "(): cSetLevel           is " + std::to_string(cSetLevel));
+                routeLogByValue(LOG_TYPE::INFO, "%s(): cSetLevel           is %d", __func__, cSetLevel);
         }
 
         if (ret != ESP_OK)
         {
             successFlag = false;
-            routeLogByValue(LOG_TYPE::ERROR, std::string(__func__) + "(): Error, Unable to restore cSetLevel");
+            routeLogByValue(LOG_TYPE::ERROR, "%s(): Error, Unable to restore cSetLevel", __func__);
         }
     }
 
     if (show & _showNVS)
-        routeLogByValue(LOG_TYPE::INFO, std::string(__func__) + "(): indication namespace end");
+        routeLogByValue(LOG_TYPE::INFO, "%s(): indication namespace end", __func__);
 
     if (successFlag)
     {
         if (show & _showNVS)
-            routeLogByValue(LOG_TYPE::INFO, std::string(__func__) + "(): Success");
+            routeLogByValue(LOG_TYPE::INFO, "%s(): Success", __func__);
     }
     else
-        routeLogByValue(LOG_TYPE::ERROR, std::string(__func__) + "(): Failed");
+        routeLogByValue(LOG_TYPE::ERROR, "%s(): Failed", __func__);
 
     nvs->closeNVStorage();
     xSemaphoreGive(semNVSEntry);
     return;
 
 ind_restoreVariablesFromNVS_err:
-    routeLogByValue(LOG_TYPE::ERROR, std::string(__func__) + "(): Error " + esp_err_to_name(ret));
+    routeLogByValue(LOG_TYPE::ERROR, "%s(): Error %s", __func__, esp_err_to_name(ret));
     xSemaphoreGive(semNVSEntry);
 }
 
@@ -201,22 +201,22 @@ void Indication::saveVariablesToNVS(void)
         nvs = NVS::getInstance(); // First, get the nvs object handle if didn't already.
 
     if (xSemaphoreTake(semNVSEntry, portMAX_DELAY))
-        ESP_GOTO_ON_ERROR(nvs->openNVSStorage("indication"), ind_saveVariablesToNVS_err, TAG, "nvs->openNVSStorage('indication') failed");
+        ESP_GOTO_ON_ERROR(nvs->openNVSStorage(nvsNamespace), ind_saveVariablesToNVS_err, TAG, "nvs->openNVSStorage('%s') failed", nvsNamespace);
 
     if (show & _showNVS)
-        routeLogByValue(LOG_TYPE::INFO, std::string(__func__) + "(): indication namespace start");
+        routeLogByValue(LOG_TYPE::INFO, "%s(): indication namespace start", __func__);
 
     if (successFlag) // Save runStackSizeK
     {
         if (nvs->writeU8IntegerToNVS("runStackSizeK", runStackSizeK) == ESP_OK)
         {
             if (show & _showNVS)
-                routeLogByValue(LOG_TYPE::INFO, std::string(__func__) + "(): runStackSizeK       = " + std::to_string(runStackSizeK));
+                routeLogByValue(LOG_TYPE::INFO, "%s(): runStackSizeK       = %d", __func__, runStackSizeK);
         }
         else
         {
             successFlag = false;
-            routeLogByValue(LOG_TYPE::ERROR, std::string(__func__) + "(): Unable to save runStackSizeK");
+            routeLogByValue(LOG_TYPE::ERROR, "%s(): Unable to save runStackSizeK", __func__);
         }
     }
 
@@ -225,12 +225,12 @@ void Indication::saveVariablesToNVS(void)
         if (nvs->writeU8IntegerToNVS("aState", (int)aState) == ESP_OK)
         {
             if (show & _showNVS)
-                routeLogByValue(LOG_TYPE::INFO, std::string(__func__) + "(): aState = " + std::to_string((int)aState));
+                routeLogByValue(LOG_TYPE::INFO, "%s(): aState = %d", __func__, (int)aState);
         }
         else
         {
             successFlag = false;
-            routeLogByValue(LOG_TYPE::ERROR, std::string(__func__) + "(): Unable to save aState");
+            routeLogByValue(LOG_TYPE::ERROR, "%s(): Unable to save aState", __func__);
         }
     }
 
@@ -239,12 +239,12 @@ void Indication::saveVariablesToNVS(void)
         if (nvs->writeU8IntegerToNVS("bState", (int)bState) == ESP_OK)
         {
             if (show & _showNVS)
-                routeLogByValue(LOG_TYPE::INFO, std::string(__func__) + "(): bState = " + std::to_string((int)bState));
+                routeLogByValue(LOG_TYPE::INFO, "%s(): bState = %d", __func__, (int)bState);
         }
         else
         {
             successFlag = false;
-            routeLogByValue(LOG_TYPE::ERROR, std::string(__func__) + "(): Unable to save bState");
+            routeLogByValue(LOG_TYPE::ERROR, "%s(): Unable to save bState", __func__);
         }
     }
 
@@ -253,12 +253,12 @@ void Indication::saveVariablesToNVS(void)
         if (nvs->writeU8IntegerToNVS("cState", (int)cState) == ESP_OK)
         {
             if (show & _showNVS)
-                routeLogByValue(LOG_TYPE::INFO, std::string(__func__) + "(): cState = " + std::to_string((int)cState));
+                routeLogByValue(LOG_TYPE::INFO, "%s(): cState = %d", __func__, (int)cState);
         }
         else
         {
             successFlag = false;
-            routeLogByValue(LOG_TYPE::ERROR, std::string(__func__) + "(): Unable to save cState");
+            routeLogByValue(LOG_TYPE::ERROR, "%s(): Unable to save cState", __func__);
         }
     }
 
@@ -267,12 +267,12 @@ void Indication::saveVariablesToNVS(void)
         if (nvs->writeU8IntegerToNVS("aSetLevel", (int)aSetLevel) == ESP_OK)
         {
             if (show & _showNVS)
-                routeLogByValue(LOG_TYPE::INFO, std::string(__func__) + "(): aSetLevel = " + std::to_string((int)aSetLevel));
+                routeLogByValue(LOG_TYPE::INFO, "%s(): aSetLevel = %d", __func__, (int)aSetLevel);
         }
         else
         {
             successFlag = false;
-            routeLogByValue(LOG_TYPE::ERROR, std::string(__func__) + "(): Unable to save aSetLevel");
+            routeLogByValue(LOG_TYPE::ERROR, "%s(): Unable to save aSetLevel", __func__);
         }
     }
 
@@ -281,12 +281,12 @@ void Indication::saveVariablesToNVS(void)
         if (nvs->writeU8IntegerToNVS("bSetLevel", (int)bSetLevel) == ESP_OK)
         {
             if (show & _showNVS)
-                routeLogByValue(LOG_TYPE::INFO, std::string(__func__) + "(): bSetLevel = " + std::to_string((int)bSetLevel));
+                routeLogByValue(LOG_TYPE::INFO, "%s(): bSetLevel = %d", __func__, (int)bSetLevel);
         }
         else
         {
             successFlag = false;
-            routeLogByValue(LOG_TYPE::ERROR, std::string(__func__) + "(): Unable to save bSetLevel");
+            routeLogByValue(LOG_TYPE::ERROR, "%s(): Unable to save bSetLevel", __func__);
         }
     }
 
@@ -295,31 +295,31 @@ void Indication::saveVariablesToNVS(void)
         if (nvs->writeU8IntegerToNVS("cSetLevel", (int)cSetLevel) == ESP_OK)
         {
             if (show & _showNVS)
-                routeLogByValue(LOG_TYPE::INFO, std::string(__func__) + "(): cSetLevel = " + std::to_string((int)cSetLevel));
+                routeLogByValue(LOG_TYPE::INFO, "%s(): cSetLevel = %d", __func__, (int)cSetLevel);
         }
         else
         {
             successFlag = false;
-            routeLogByValue(LOG_TYPE::ERROR, std::string(__func__) + "(): Unable to save cSetLevel");
+            routeLogByValue(LOG_TYPE::ERROR, "%s(): Unable to save cSetLevel", __func__);
         }
     }
 
     if (show & _showNVS)
-        routeLogByValue(LOG_TYPE::INFO, std::string(__func__) + "(): indication namespace end");
+        routeLogByValue(LOG_TYPE::INFO, "%s(): indication namespace end", __func__);
 
     if (successFlag)
     {
         if (show & _showNVS)
-            routeLogByValue(LOG_TYPE::INFO, std::string(__func__) + "(): Success");
+            routeLogByValue(LOG_TYPE::INFO, "%s(): Success", __func__);
     }
     else
-        routeLogByValue(LOG_TYPE::ERROR, std::string(__func__) + "(): Failed");
+        routeLogByValue(LOG_TYPE::ERROR, "%s(): Failed", __func__);
 
     nvs->closeNVStorage();
     xSemaphoreGive(semNVSEntry);
     return;
 
 ind_saveVariablesToNVS_err:
-    routeLogByValue(LOG_TYPE::ERROR, std::string(__func__) + "(): Error " + esp_err_to_name(ret));
+    routeLogByValue(LOG_TYPE::ERROR, "%s(): Error %s", __func__, esp_err_to_name(ret));
     xSemaphoreGive(semNVSEntry);
 }
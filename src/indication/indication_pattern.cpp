@@ -0,0 +1,162 @@
+#include "indication/indication_.hpp"
+
+//
+// A pattern table holds ready made programs in flash, so producers only send a pattern id.  Each priority class has a queue of
+// single byte ids beside its command queue.  The table is read in place -- either const data linked into the application or
+// a data partition mapped with esp_partition_mmap(), which can be rewritten without rebuilding the producers.
+//
+// Table layout in 32 bit words (see IND_ROM_xxx() in indication_defs.hpp):
+//
+//   IND_ROM_MAGIC, count
+//   IND_ROM_ENTRY(offset, length) x count -- offset is in words from the start of the table
+//   program words of every pattern        -- the same instructions as registerProgram() takes
+//
+// Every pattern is validated once when the table is loaded.  A table is loaded once and stays for the life of the object.
+//
+
+/* Pattern Table */
+esp_err_t Indication::loadPatternTable(const uint32_t *table, size_t words)
+{
+    esp_err_t ret = ESP_OK;
+
+    ESP_RETURN_ON_FALSE(patternTable == nullptr, ESP_ERR_INVALID_STATE, TAG, "a pattern table is already loaded");
+    ESP_RETURN_ON_ERROR(validatePatternTable(table, words), TAG, "pattern table is not valid");
+
+    taskENTER_CRITICAL(&programLock);
+    if (patternTable == nullptr)
+    {
+        patternTable = table;
+        patternWords = words;
+        patternCount = table[1];
+    }
+    else
+        ret = ESP_ERR_INVALID_STATE; // Another task loaded one first
+    taskEXIT_CRITICAL(&programLock);
+    return ret;
+}
+
+esp_err_t Indication::mapPatternPartition(const char *label)
+{
+    esp_err_t ret = ESP_OK;
+    const esp_partition_t *partition = nullptr;
+    const void *data = nullptr;
+    esp_partition_mmap_handle_t handle = 0;
+
+    if (label == nullptr)
+        label = CONFIG_WS2812_PATTERN_PARTITION;
+
+    ESP_RETURN_ON_FALSE(!patternMapped, ESP_ERR_INVALID_STATE, TAG, "a pattern partition is already mapped");
+
+    partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, label);
+    ESP_RETURN_ON_FALSE(partition, ESP_ERR_NOT_FOUND, TAG, "pattern partition %s not found", label);
+
+    ESP_RETURN_ON_ERROR(esp_partition_mmap(partition, 0, partition->size, ESP_PARTITION_MMAP_DATA, &data, &handle), TAG, "esp_partition_mmap() failed");
+
+    ret = loadPatternTable((const uint32_t *)data, partition->size / sizeof(uint32_t));
+    if (ret != ESP_OK)
+    {
+        esp_partition_munmap(handle);
+        return ret;
+    }
+
+    patternMap = handle;
+    patternMapped = true;
+    return ESP_OK;
+}
+
+esp_err_t Indication::submitPattern(uint8_t id, TickType_t ticksToWait, IND_PRIORITY priority)
+{
+    uint8_t count = 0;
+
+    taskENTER_CRITICAL(&programLock);
+    count = patternCount;
+    taskEXIT_CRITICAL(&programLock);
+
+    ESP_RETURN_ON_FALSE((uint8_t)priority < IND_PRIORITY_CLASSES, ESP_ERR_INVALID_ARG, TAG, "unknown priority class");
+    ESP_RETURN_ON_FALSE(id < count, ESP_ERR_INVALID_ARG, TAG, "pattern is not in the table");
+    ESP_RETURN_ON_FALSE(queHandleIndPattern[(uint8_t)priority] != nullptr, ESP_ERR_INVALID_STATE, TAG, "pattern queue does not exist");
+
+    taskENTER_CRITICAL(&queLock);
+    queStats.submitted++;
+    taskEXIT_CRITICAL(&queLock);
+
+    if (xQueueSendToBack(queHandleIndPattern[(uint8_t)priority], &id, ticksToWait) != pdTRUE)
+    {
+        taskENTER_CRITICAL(&queLock);
+        queStats.timedOut++;
+        taskEXIT_CRITICAL(&queLock);
+        return ESP_ERR_TIMEOUT;
+    }
+
+    taskENTER_CRITICAL(&queLock);
+    queStats.queued++;
+    taskEXIT_CRITICAL(&queLock);
+
+    wakeRunTask();
+    return ESP_OK;
+}
+
+esp_err_t Indication::validatePatternTable(const uint32_t *table, size_t words)
+{
+    uint32_t count = 0;
+    uint32_t offset = 0;
+    uint32_t length = 0;
+
+    ESP_RETURN_ON_FALSE(table, ESP_ERR_INVALID_ARG, TAG, "table can not be null...");
+    ESP_RETURN_ON_FALSE((words >= 2) && (table[0] == IND_ROM_MAGIC), ESP_ERR_INVALID_ARG, TAG, "no pattern table header");
+
+    count = table[1];
+    ESP_RETURN_ON_FALSE((count > 0) && (count <= IND_ROM_MAX_PATTERNS) && ((2 + count) <= words), ESP_ERR_INVALID_ARG, TAG, "pattern count is not valid");
+
+    for (uint32_t id = 0; id < count; id++)
+    {
+        offset = table[2 + id] >> 16;
+        length = table[2 + id] & 0xFFFF;
+
+        ESP_RETURN_ON_FALSE((offset >= (2 + count)) && (length > 0) && ((offset + length) <= words), ESP_ERR_INVALID_ARG, TAG, "pattern %ld is out of bounds", id);
+        ESP_RETURN_ON_ERROR(validateProgram(&table[offset], length), TAG, "pattern %ld is not valid", id);
+    }
+    return ESP_OK;
+}
+
+void Indication::unmapPatternPartition(void)
+{
+    if (patternMapped)
+    {
+        esp_partition_munmap(patternMap);
+        patternMapped = false;
+        patternTable = nullptr;
+        patternCount = 0;
+    }
+}
+
+/* Run Task Side */
+bool Indication::fetchPattern(uint8_t priority, ind_cmd_t *cmd)
+{
+    uint8_t id = 0;
+
+    if (xQueueReceive(queHandleIndPattern[priority], &id, 0) != pdTRUE)
+        return false;
+
+    *cmd = {id, (IND_PRIORITY)priority, CMD_Pattern};
+    return true;
+}
+
+void Indication::startPattern(uint8_t id)
+{
+    const uint32_t *table = nullptr;
+    uint8_t count = 0;
+
+    taskENTER_CRITICAL(&programLock);
+    table = patternTable;
+    count = patternCount;
+    taskEXIT_CRITICAL(&programLock);
+
+    if ((table == nullptr) || (id >= count))
+    {
+        routeLogByValue(LOG_TYPE::ERROR, "%s(): Error, pattern %d is not in the table", __func__, id);
+        return;
+    }
+
+    runProgram(&table[table[2 + id] >> 16], table[2 + id] & 0xFFFF); // Zero-copy -- the program runs straight from the table
+}
@@ -0,0 +1,155 @@
+#include "indication/indication_.hpp"
+
+//
+// Automatic light sleep is allowed whenever we are not holding our power lock.  We hold it while a sequence is playing (the
+// run task counts dwell steps and the LED changes every few of them) and for the few microseconds of any frame sent outside a
+// sequence.  Between indications the WS2812 latches its last frame by itself, so nothing is lost while the chip sleeps.
+//
+// The RMT channel holds a power management lock of its own while it is enabled, so it is disabled whenever the LED is idle
+// (see demolishRMTDriver()).  The times we hold our lock are counted even when power management is not built in.
+//
+// Frame current is estimated from the per level currents in Kconfig: the sum of each channel over the frame times its uA per
+// level, plus the quiescent current of every pixel.  limitFramePower() scales every byte of a frame that is over budget by one
+// 16 bit fraction, so colors keep their balance.  Both are one pass of byte sums or byte multiplies with no divisions inside
+// the loop.  Buffers are GRB, 3 bytes per pixel, the same as the effect kernels.
+//
+
+/* Power Lock */
+void Indication::createPowerLock(void)
+{
+#if CONFIG_WS2812_PM_LOCK
+    esp_err_t ret = ESP_OK;
+
+    ESP_GOTO_ON_ERROR(esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, "ind", &pmLock), ind_createPowerLock_err, TAG, "esp_pm_lock_create() failed");
+    resetPowerStats();
+    return;
+
+ind_createPowerLock_err:
+    routeLogByValue(LOG_TYPE::ERROR, "%s(): error: %s", __func__, esp_err_to_name(ret));
+#else
+    resetPowerStats();
+#endif
+}
+
+void Indication::destroyPowerLock(void)
+{
+    holdPower(false);
+
+#if CONFIG_WS2812_PM_LOCK
+    if (pmLock != nullptr)
+    {
+        esp_pm_lock_delete(pmLock);
+        pmLock = nullptr;
+    }
+#endif
+}
+
+void Indication::holdPower(bool hold)
+{
+    // Only the run task (or the shared task serving us) calls this, so powerHeld needs no lock
+    int64_t now = 0;
+
+    if (hold == powerHeld)
+        return;
+    powerHeld = hold;
+
+#if CONFIG_WS2812_PM_LOCK
+    if (pmLock != nullptr)
+    {
+        if (hold)
+            esp_pm_lock_acquire(pmLock);
+        else
+            esp_pm_lock_release(pmLock);
+    }
+#endif
+
+    now = esp_timer_get_time();
+
+    taskENTER_CRITICAL(&pmStatsLock);
+    if (hold)
+    {
+        pmStats.acquired++;
+        pmTakenUs = now;
+    }
+    else
+        pmStats.heldUs += now - pmTakenUs;
+    pmStats.held = hold;
+    taskEXIT_CRITICAL(&pmStatsLock);
+}
+
+/* Frame Power Budget */
+static uint64_t frameDriveUa(const uint8_t *grb, uint16_t pixels)
+{
+    uint32_t sumG = 0; // 255 * 65535 still fits
+    uint32_t sumR = 0;
+    uint32_t sumB = 0;
+
+    for (uint32_t i = 0; i < pixels; i++)
+    {
+        sumG += grb[(i * 3) + 0];
+        sumR += grb[(i * 3) + 1];
+        sumB += grb[(i * 3) + 2];
+    }
+
+    return ((uint64_t)sumG * CONFIG_WS2812_GREEN_UA_PER_LEVEL) + ((uint64_t)sumR * CONFIG_WS2812_RED_UA_PER_LEVEL) + ((uint64_t)sumB * CONFIG_WS2812_BLUE_UA_PER_LEVEL);
+}
+
+uint32_t Indication::estimateFramePower(const uint8_t *grb, uint16_t pixels)
+{
+    if (grb == nullptr)
+        return 0;
+
+    return (uint32_t)((frameDriveUa(grb, pixels) + ((uint64_t)pixels * CONFIG_WS2812_PIXEL_IDLE_UA) + 999) / 1000); // mA, rounded up
+}
+
+uint32_t Indication::limitFramePower(uint8_t *grb, uint16_t pixels, uint32_t budgetMa)
+{
+    // Returns the estimate before limiting, in mA.  Only the drive current can be scaled -- the quiescent current is always there.
+    uint64_t idleUa = (uint64_t)pixels * CONFIG_WS2812_PIXEL_IDLE_UA;
+    uint64_t budgetUa = (uint64_t)budgetMa * 1000;
+    uint64_t driveUa = 0;
+    uint32_t scale = 0; // 0.16 fixed point
+    uint32_t bytes = pixels * 3;
+
+    if (grb == nullptr)
+        return 0;
+
+    driveUa = frameDriveUa(grb, pixels);
+    if ((driveUa + idleUa) <= budgetUa) // The usual case -- nothing to do
+        return (uint32_t)((driveUa + idleUa + 999) / 1000);
+
+    if (budgetUa > idleUa)
+        scale = (uint32_t)(((budgetUa - idleUa) << 16) / driveUa); // Below 65536 because we are over budget
+    for (uint32_t i = 0; i < bytes; i++)
+        grb[i] = (grb[i] * scale) >> 16; // Rounds down, so the result never goes over
+
+    return (uint32_t)((driveUa + idleUa + 999) / 1000);
+}
+
+/* Power Statistics */
+void Indication::getPowerStats(ind_power_stats_t *stats)
+{
+    int64_t now = esp_timer_get_time();
+
+    if (stats == nullptr)
+        return;
+
+    taskENTER_CRITICAL(&pmStatsLock);
+    *stats = pmStats;
+    if (stats->held) // Count the hold in progress up to now
+        stats->heldUs += now - pmTakenUs;
+    taskEXIT_CRITICAL(&pmStatsLock);
+}
+
+void Indication::resetPowerStats(void)
+{
+    int64_t now = esp_timer_get_time();
+
+    taskENTER_CRITICAL(&pmStatsLock);
+    pmStats.acquired = 0;
+    pmStats.heldUs = 0;
+    pmStats.limited = 0;
+    pmStats.sinceUs = now;
+    pmTakenUs = now; // A hold in progress is counted from here
+    taskEXIT_CRITICAL(&pmStatsLock);
+}
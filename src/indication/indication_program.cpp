@@ -0,0 +1,385 @@
+#include "indication/indication_.hpp"
+
+//
+// Indication programs are short arrays of 32 bit words for patterns the classic command word can not express.  The top byte
+// of each word is an opcode and the lower 24 bits are its operands (see IND_OP_xxx() in indication_defs.hpp):
+//
+//   SET  set, clear           -- like setAndClearColors().  Channel states and levels still apply.
+//   FADE colors, level, steps -- ramp colors from where they are to level (255 is the set level) over a number of dwell steps
+//   WAIT steps                -- hold for a number of dwell steps
+//   LOOP target, count        -- go back to target count more times
+//   JUMP target               -- continue at target
+//   CODE word                 -- play a classic 32 bit command (held in the next word) to its end
+//   END
+//
+// A program is checked once by registerProgram() and is only referred to by its slot id after that.  The run task executes
+// instructions until one of them takes time, then picks up again on a later dwell step.  Nothing is decoded while waiting.
+//
+// The checks make sure every target is an instruction, loops nest no deeper than IND_PROG_LOOP_DEPTH, a jump never crosses into
+// or out of a loop, and the path taken from every backward branch target (following jumps) passes a WAIT, FADE or blinking CODE
+// before it comes back to the branch, so a program can never spin without time passing.  A program that runs off its end
+// behaves as END.
+//
+static_assert(sizeof(((ind_prog_state_t *)0)->loop) / sizeof(ind_prog_loop_t) == IND_PROG_LOOP_DEPTH, "ind_prog_state_t loop stack must match IND_PROG_LOOP_DEPTH");
+
+static bool isBlinkCode(uint32_t value)
+{
+    uint8_t cycles = (0x0F000000 & value) >> 24;
+    return (cycles != 0x0) && (cycles != 0xE) && (cycles != 0xF);
+}
+
+static bool isInstruction(const uint32_t *code, uint16_t length, uint16_t target)
+{
+    // Walk from the start because the word after a CODE is an operand, not an instruction
+    for (uint16_t pc = 0; pc < length; pc++)
+    {
+        if (pc == target)
+            return true;
+        if (pc > target)
+            return false;
+        if ((code[pc] >> 24) == OP_Code)
+            pc++;
+    }
+    return false;
+}
+
+static bool takesTime(const uint32_t *code, uint16_t length, uint16_t from, uint16_t to)
+{
+    // Follows the path the run task would take from a branch target, not the address range, so a forward JUMP that skips the
+    // only WAIT is caught.  An inner LOOP counts as time because its own body is checked the same way.  More steps than the
+    // program has words without reaching the branch means a cycle of its own with no time in it.
+    uint16_t pc = from;
+
+    for (uint16_t steps = 0; steps <= length; steps++)
+    {
+        if (pc >= length) // Runs off the end, which is END
+            return true;
+        if (pc == to) // Back at the branch and no time has passed
+            return false;
+
+        switch (code[pc] >> 24)
+        {
+        case OP_Fade:
+        case OP_Wait:
+        case OP_Loop:
+        case OP_End:
+            return true;
+
+        case OP_Jump:
+            pc = code[pc] & 0xFFFF;
+            break;
+
+        case OP_Code:
+            if (((pc + 1) < length) && isBlinkCode(code[pc + 1]))
+                return true;
+            pc += 2;
+            break;
+
+        default:
+            pc++;
+            break;
+        }
+    }
+    return false;
+}
+
+/* Program Registration */
+esp_err_t Indication::registerProgram(const uint32_t *code, uint16_t length, uint8_t *id)
+{
+    esp_err_t ret = ESP_OK;
+
+    ESP_RETURN_ON_FALSE(id, ESP_ERR_INVALID_ARG, TAG, "id can not be null...");
+    ESP_RETURN_ON_ERROR(validateProgram(code, length), TAG, "program is not valid");
+
+    taskENTER_CRITICAL(&programLock);
+    if (programCount < CONFIG_WS2812_PROGRAM_SLOTS)
+    {
+        programs[programCount] = {code, length};
+        *id = programCount++;
+    }
+    else
+        ret = ESP_ERR_NO_MEM;
+    taskEXIT_CRITICAL(&programLock);
+
+    ESP_RETURN_ON_ERROR(ret, TAG, "no free program slot");
+    return ESP_OK;
+}
+
+esp_err_t Indication::submitProgram(uint8_t id, TickType_t ticksToWait, IND_PRIORITY priority, ind_ticket_t *ticket)
+{
+    ind_cmd_t cmd = {id, priority, CMD_Program, ticket};
+    uint8_t count = 0;
+
+    taskENTER_CRITICAL(&programLock);
+    count = programCount;
+    taskEXIT_CRITICAL(&programLock);
+
+    ESP_RETURN_ON_FALSE((uint8_t)priority < IND_PRIORITY_CLASSES, ESP_ERR_INVALID_ARG, TAG, "unknown priority class");
+    ESP_RETURN_ON_FALSE(id < count, ESP_ERR_INVALID_ARG, TAG, "program is not registered");
+
+    return submitCmd(&cmd, ticksToWait);
+}
+
+esp_err_t Indication::validateProgram(const uint32_t *code, uint16_t length)
+{
+    uint16_t target = 0;
+
+    ESP_RETURN_ON_FALSE(code, ESP_ERR_INVALID_ARG, TAG, "code can not be null...");
+    ESP_RETURN_ON_FALSE(length > 0, ESP_ERR_INVALID_ARG, TAG, "program is empty");
+
+    for (uint16_t pc = 0; pc < length; pc++)
+    {
+        target = code[pc] & 0xFFFF;
+
+        switch (code[pc] >> 24)
+        {
+        case OP_End:
+        case OP_Set:
+            break;
+
+        case OP_Fade:
+            ESP_RETURN_ON_FALSE((code[pc] & 0xFF) > 0, ESP_ERR_INVALID_ARG, TAG, "FADE at %d needs at least one step", pc);
+            break;
+
+        case OP_Wait:
+            ESP_RETURN_ON_FALSE(target > 0, ESP_ERR_INVALID_ARG, TAG, "WAIT at %d needs at least one step", pc);
+            break;
+
+        case OP_Loop:
+            ESP_RETURN_ON_FALSE(((code[pc] >> 16) & 0xFF) > 0, ESP_ERR_INVALID_ARG, TAG, "LOOP at %d needs a count", pc);
+            ESP_RETURN_ON_FALSE((target < pc) && isInstruction(code, length, target), ESP_ERR_INVALID_ARG, TAG, "LOOP at %d must go back to an instruction", pc);
+            ESP_RETURN_ON_FALSE(takesTime(code, length, target, pc), ESP_ERR_INVALID_ARG, TAG, "LOOP at %d never waits", pc);
+            break;
+
+        case OP_Jump:
+            ESP_RETURN_ON_FALSE((target < length) && isInstruction(code, length, target), ESP_ERR_INVALID_ARG, TAG, "JUMP at %d must land on an instruction", pc);
+            ESP_RETURN_ON_FALSE((target > pc) || takesTime(code, length, target, pc), ESP_ERR_INVALID_ARG, TAG, "JUMP at %d never waits", pc);
+            break;
+
+        case OP_Code:
+            ESP_RETURN_ON_FALSE((pc + 1) < length, ESP_ERR_INVALID_ARG, TAG, "CODE at %d is missing its command word", pc);
+            ESP_RETURN_ON_FALSE(code[pc + 1] != IND_CMD_WAKE, ESP_ERR_INVALID_ARG, TAG, "CODE at %d holds a reserved command", pc);
+            pc++;
+            break;
+
+        default:
+            ESP_RETURN_ON_FALSE(false, ESP_ERR_INVALID_ARG, TAG, "unknown opcode at %d", pc);
+        }
+    }
+
+    // Loops must nest, no deeper than our loop stack, and no jump may cross a loop boundary
+    for (uint16_t i = 0; i < length; i++)
+    {
+        uint16_t iStart = code[i] & 0xFFFF;
+        uint8_t depth = 1;
+
+        if (!isInstruction(code, length, i))
+            continue;
+
+        if ((code[i] >> 24) == OP_Jump)
+        {
+            for (uint16_t j = 0; j < length; j++)
+            {
+                uint16_t jStart = code[j] & 0xFFFF;
+
+                if (((code[j] >> 24) != OP_Loop) || !isInstruction(code, length, j))
+                    continue;
+                ESP_RETURN_ON_FALSE(((jStart <= i) && (i <= j)) == ((jStart <= iStart) && (iStart <= j)), ESP_ERR_INVALID_ARG, TAG, "JUMP at %d crosses the loop at %d", i, j);
+            }
+        }
+
+        if ((code[i] >> 24) != OP_Loop)
+            continue;
+
+        for (uint16_t j = 0; j < length; j++)
+        {
+            uint16_t jStart = code[j] & 0xFFFF;
+
+            if ((j == i) || ((code[j] >> 24) != OP_Loop) || !isInstruction(code, length, j))
+                continue;
+
+            ESP_RETURN_ON_FALSE(!((iStart < jStart) && (jStart <= i) && (i < j)), ESP_ERR_INVALID_ARG, TAG, "loops at %d and %d overlap", i, j);
+
+            if ((jStart <= iStart) && (i < j)) // Loop j holds loop i
+                depth++;
+        }
+
+        ESP_RETURN_ON_FALSE(depth <= IND_PROG_LOOP_DEPTH, ESP_ERR_INVALID_ARG, TAG, "loops nest too deeply at %d", i);
+    }
+
+    return ESP_OK;
+}
+
+/* Program Execution */
+void Indication::startProgram(uint8_t id)
+{
+    ind_program_t program = {};
+
+    taskENTER_CRITICAL(&programLock);
+    if (id < programCount)
+        program = programs[id];
+    taskEXIT_CRITICAL(&programLock);
+
+    if (program.code == nullptr)
+    {
+        routeLogByValue(LOG_TYPE::ERROR, "%s(): Error, program %d is not registered", __func__, id);
+        return;
+    }
+
+    runProgram(program.code, program.length);
+}
+
+void Indication::runProgram(const uint32_t *code, uint16_t length)
+{
+    esp_err_t ret = ESP_OK;
+
+    if (!rmtEstablished)
+        ESP_GOTO_ON_ERROR(establishRMTDriver(), ind_runProgram_err, TAG, "establishRMTDriver() failed");
+
+    prog = {};
+    prog.code = code; // Read in place -- the words are never copied
+    prog.length = length;
+
+    progActive = true;
+    IsIndicating = true;
+    indState = IND_STATES::Program;
+
+    stepProgram(); // The first instructions run right away
+    return;
+
+ind_runProgram_err:
+    errFunc = __func__;
+    errCode = ret;
+    indOP = IND_OP::Error;
+}
+
+void Indication::stepProgram(void)
+{
+    uint32_t word = 0;
+
+    if ((prog.wait > 0) && (--prog.wait > 0))
+        return;
+
+    if (isFading())
+    {
+        fadeTick();
+        return;
+    }
+
+    for (uint8_t budget = 0; budget < IND_PROG_STEP_BUDGET; budget++)
+    {
+        if (prog.pc >= prog.length) // Running off the end is the same as END
+            word = IND_OP_END();
+        else
+            word = prog.code[prog.pc];
+
+        switch (word >> 24)
+        {
+        case OP_Set:
+        {
+            setAndClearColors(word & 0x07, (word >> 8) & 0x07);
+            prog.pc++;
+            break;
+        }
+
+        case OP_Fade:
+        {
+            prog.pc++;
+            startFade((word >> 16) & 0x07, (word >> 8) & 0xFF, word & 0xFF, (word & IND_FADE_EASED_BIT) != 0);
+            return;
+        }
+
+        case OP_Wait:
+        {
+            prog.wait = word & 0xFFFF;
+            prog.pc++;
+            return;
+        }
+
+        case OP_Loop:
+        {
+            if ((prog.loopDepth > 0) && (prog.loop[prog.loopDepth - 1].pc == prog.pc)) // Our counter is on top
+            {
+                if (prog.loop[prog.loopDepth - 1].remaining > 0)
+                {
+                    prog.loop[prog.loopDepth - 1].remaining--;
+                    prog.pc = word & 0xFFFF;
+                }
+                else
+                {
+                    prog.loopDepth--;
+                    prog.pc++;
+                }
+            }
+            else // First time around.  Validation keeps the stack from overflowing.
+            {
+                prog.loop[prog.loopDepth++] = {prog.pc, (uint8_t)(((word >> 16) & 0xFF) - 1)};
+                prog.pc = word & 0xFFFF;
+            }
+            break;
+        }
+
+        case OP_Jump:
+        {
+            prog.pc = word & 0xFFFF;
+            break;
+        }
+
+        case OP_Code:
+        {
+            prog.pc += 2;
+            startIndication(prog.code[prog.pc - 1]); // A blink code moves us into the classic states until its Final
+            if (indState != IND_STATES::Program)
+                return;
+            break; // A state change takes no time
+        }
+
+        default: // OP_End
+        {
+            setAndClearColors(0, COLORA_Bit | COLORB_Bit | COLORC_Bit); // Leave the LED as a classic command would
+            progActive = false;
+            indState = IND_STATES::Final;
+            return;
+        }
+        }
+    }
+
+    routeLogByValue(LOG_TYPE::ERROR, "%s(): Error, program exceeded its step budget", __func__);
+    setAndClearColors(0, COLORA_Bit | COLORB_Bit | COLORC_Bit); // A runaway program must not leave the LED lit
+    progActive = false;
+    indState = IND_STATES::Final;
+}
+
+/* Version Program */
+void Indication::startVersionFlash(void)
+{
+    // The start-up flash of majorVer (ColorA), minorVer (ColorB) and patchNumber (ColorC) as an ordinary program.  Each blink
+    // is 100mSec on and 150mSec off, with another 250mSec of dark between the digits.  A digit of zero shows only the dark.
+    const uint8_t counts[3] = {majorVer, minorVer, patchNumber};
+    const uint8_t colors[3] = {COLORA_Bit, COLORB_Bit, COLORC_Bit};
+    uint16_t start = 0;
+
+    versionLength = 0;
+
+    for (uint8_t d = 0; d < 3; d++)
+    {
+        start = versionLength;
+
+        if (counts[d] > 0)
+        {
+            versionProgram[versionLength++] = IND_OP_SET(colors[d], 0);
+            versionProgram[versionLength++] = IND_OP_WAIT(100000 / IND_DWELL_US);
+            versionProgram[versionLength++] = IND_OP_SET(0, colors[d]);
+            versionProgram[versionLength++] = IND_OP_WAIT(150000 / IND_DWELL_US);
+            if (counts[d] > 1)
+                versionProgram[versionLength++] = IND_OP_LOOP(start, counts[d] - 1);
+            versionProgram[versionLength++] = IND_OP_WAIT(250000 / IND_DWELL_US);
+        }
+        else
+            versionProgram[versionLength++] = IND_OP_WAIT(400000 / IND_DWELL_US);
+    }
+    versionProgram[versionLength++] = IND_OP_END();
+
+    activeCmd = {0, IND_PRIORITY::Routine, CMD_Version}; // The lowest class, so every real status code goes ahead of it
+    startCommand();
+}
@@ -0,0 +1,455 @@
+#include "indication/indication_.hpp"
+
+//
+// submitIndication() is the managed way into our command queues.  Each priority class owns a queue of ind_cmd_t.  The raw queue
+// handle from getCmdRequestQueue() still works and is served as Routine, but those senders choose their own behavior when the
+// queue is full and they are invisible to our policy and counters.
+//
+// The run task blocks on the raw queue while it is idle.  When a submitter finds it waiting there, it pushes IND_CMD_WAKE to the
+// front of that queue so the run task looks at the class queues right away.
+//
+// Coalescing relies on a small shadow copy of the commands we placed in the class queues.  An entry is added before the send and
+// removed when the run task receives the command (or when DropOldest discards it).  A stale shadow could only cost a missed
+// coalesce -- it never absorbs a command that is not pending.
+//
+// Each priority class has its own submit lock, held only while the policy is decided and the first send is tried.  A Block submitter that finds its queue
+// full gives the lock back before it waits, so it never holds up other submitters, and the whole call stays within ticksToWait.
+// Its shadow entry is removed before it waits.  Only commands that are really in the queue may absorb an identical one -- a
+// waiting sender may still time out, and the caller it absorbed would have been told its command was queued.
+//
+
+/* Command Queue */
+esp_err_t Indication::submitIndication(uint32_t value, TickType_t ticksToWait, IND_PRIORITY priority, ind_ticket_t *ticket)
+{
+    ind_cmd_t cmd = {value, priority, 0, ticket};
+
+    ESP_RETURN_ON_FALSE((uint8_t)priority < IND_PRIORITY_CLASSES, ESP_ERR_INVALID_ARG, TAG, "unknown priority class");
+    ESP_RETURN_ON_FALSE(value != IND_CMD_WAKE, ESP_ERR_INVALID_ARG, TAG, "command value is reserved");
+
+    return submitCmd(&cmd, ticksToWait);
+}
+
+esp_err_t Indication::submitCmd(ind_cmd_t *command, TickType_t ticksToWait)
+{
+    esp_err_t ret = ESP_OK;
+    ind_cmd_t cmd = *command;
+    ind_cmd_t oldest = {};
+    ind_ticket_t *ticket = cmd.ticket;
+    QueueHandle_t queue = nullptr;
+    SemaphoreHandle_t lock = nullptr;
+    TimeOut_t timeOut = {};
+    uint8_t policy = 0;
+    bool wait = false;
+
+    queue = queHandleIndPriority[(uint8_t)cmd.priority];
+    lock = semSubmitLock[(uint8_t)cmd.priority];
+    ESP_RETURN_ON_FALSE(queue != nullptr, ESP_ERR_INVALID_STATE, TAG, "command queue does not exist");
+
+    if (ticket != nullptr)
+    {
+        ticket->state = IND_TICKET::Queued;
+        ticket->enqueueUs = esp_timer_get_time();
+        ticket->startUs = 0;
+        ticket->finishUs = 0;
+    }
+
+    vTaskSetTimeOutState(&timeOut);
+    if (xSemaphoreTake(lock, ticksToWait) != pdTRUE) // Submitters of a class are serialized so the policy decision and the first send act as one step
+    {
+        taskENTER_CRITICAL(&queLock);
+        queStats.submitted++;
+        queStats.timedOut++;
+        taskEXIT_CRITICAL(&queLock);
+
+        if (ticket != nullptr)
+            signalTicket(ticket, IND_TICKET::Dropped);
+        return ESP_ERR_TIMEOUT;
+    }
+
+    policy = quePolicy;
+
+    taskENTER_CRITICAL(&queLock);
+    queStats.submitted++;
+    taskEXIT_CRITICAL(&queLock);
+
+    if (policy & QUE_Coalesce)
+    {
+        if (isCmdPending(&cmd))
+        {
+            taskENTER_CRITICAL(&queLock);
+            queStats.coalesced++;
+            taskEXIT_CRITICAL(&queLock);
+            xSemaphoreGive(lock);
+
+            if (ticket != nullptr)
+                signalTicket(ticket, IND_TICKET::Coalesced);
+            return ESP_OK; // An identical command is already waiting
+        }
+
+        addPendingCmd(&cmd); // Shadow first, so the run task can never receive a command it has no record of
+    }
+
+    if (policy & QUE_DropNewest)
+    {
+        if (xQueueSendToBack(queue, &cmd, 0) != pdTRUE)
+        {
+            taskENTER_CRITICAL(&queLock);
+            queStats.droppedNewest++;
+            taskEXIT_CRITICAL(&queLock);
+            ret = ESP_ERR_TIMEOUT;
+        }
+    }
+    else if (policy & QUE_DropOldest)
+    {
+        if (xQueueSendToBack(queue, &cmd, 0) != pdTRUE)
+        {
+            if (xQueueReceive(queue, &oldest, 0) == pdTRUE) // Make room by discarding the stalest command
+            {
+                forgetPendingCmd(&oldest);
+                taskENTER_CRITICAL(&queLock);
+                queStats.droppedOldest++;
+                taskEXIT_CRITICAL(&queLock);
+
+                if (oldest.ticket != nullptr)
+                    signalTicket(oldest.ticket, IND_TICKET::Dropped);
+            }
+
+            if (xQueueSendToBack(queue, &cmd, 0) != pdTRUE) // A raw sender may have taken the slot
+            {
+                taskENTER_CRITICAL(&queLock);
+                queStats.droppedNewest++;
+                taskEXIT_CRITICAL(&queLock);
+                ret = ESP_ERR_TIMEOUT;
+            }
+        }
+    }
+    else if (xQueueSendToBack(queue, &cmd, 0) != pdTRUE) // QUE_Block.  The queue is full, so we wait below without the lock.
+    {
+        taskENTER_CRITICAL(&queLock);
+        queStats.blocked++;
+        taskEXIT_CRITICAL(&queLock);
+        wait = true;
+
+        if (policy & QUE_Coalesce)
+            forgetPendingCmd(&cmd); // Not queued yet, so it must not absorb other submits while we wait
+    }
+
+    xSemaphoreGive(lock);
+
+    if (wait)
+    {
+        xTaskCheckForTimeOut(&timeOut, &ticksToWait); // What is left of the caller's wait after the lock
+        if (xQueueSendToBack(queue, &cmd, ticksToWait) != pdTRUE)
+        {
+            taskENTER_CRITICAL(&queLock);
+            queStats.timedOut++;
+            taskEXIT_CRITICAL(&queLock);
+            ret = ESP_ERR_TIMEOUT;
+        }
+    }
+
+    if (ret == ESP_OK)
+    {
+        taskENTER_CRITICAL(&queLock);
+        queStats.queued++;
+        taskEXIT_CRITICAL(&queLock);
+        wakeRunTask();
+    }
+    else if ((policy & QUE_Coalesce) && !wait)
+        forgetPendingCmd(&cmd); // Never reached the queue.  A waiting sender already gave up its entry.
+
+    if ((ret != ESP_OK) && (ticket != nullptr))
+        signalTicket(ticket, IND_TICKET::Dropped);
+    return ret;
+}
+
+void Indication::setQueuePolicy(uint8_t policy)
+{
+    // Exactly one overflow action is kept.  Coalesce may ride along with it.
+    uint8_t overflow = policy & (QUE_Block | QUE_DropNewest | QUE_DropOldest);
+
+    if ((overflow != QUE_Block) && (overflow != QUE_DropNewest) && (overflow != QUE_DropOldest))
+    {
+        routeLogByValue(LOG_TYPE::ERROR, "%s(): Error, policy must hold exactly one overflow action", __func__);
+        return;
+    }
+
+    for (uint8_t p = 0; p < IND_PRIORITY_CLASSES; p++) // Every class sees the change at once.  Always taken in class order.
+        xSemaphoreTake(semSubmitLock[p], portMAX_DELAY);
+
+    if (!(policy & QUE_Coalesce))
+    {
+        taskENTER_CRITICAL(&queLock);
+        quePendingCount = 0; // The shadow is only maintained while coalescing
+        taskEXIT_CRITICAL(&queLock);
+    }
+
+    quePolicy = overflow | (policy & QUE_Coalesce);
+
+    for (int8_t p = IND_PRIORITY_CLASSES - 1; p >= 0; p--)
+        xSemaphoreGive(semSubmitLock[p]);
+}
+
+uint8_t Indication::getQueuePolicy(void)
+{
+    return quePolicy;
+}
+
+void Indication::setPreemptPolicy(IND_PREEMPT policy)
+{
+    preemptPolicy = policy; // Read only by the run task at the moment of preemption
+}
+
+/* Persistent Pattern */
+esp_err_t Indication::setPersistentIndication(uint32_t value)
+{
+    uint8_t cycles = (0x0F000000 & value) >> 24;
+
+    // Only blink codes can repeat.  State changes (cycles 0x0, 0xE, 0xF) are one-shot commands.
+    ESP_RETURN_ON_FALSE((cycles != 0x0) && (cycles != 0xE) && (cycles != 0xF), ESP_ERR_INVALID_ARG, TAG, "persistent pattern must be a blink code");
+
+    taskENTER_CRITICAL(&queLock);
+    persistRequest = value;
+    persistRequestPending = true;
+    taskEXIT_CRITICAL(&queLock);
+
+    wakeRunTask();
+    return ESP_OK;
+}
+
+esp_err_t Indication::cancelPersistentIndication(void)
+{
+    taskENTER_CRITICAL(&queLock);
+    persistRequest = IND_CMD_WAKE;
+    persistRequestPending = true;
+    taskEXIT_CRITICAL(&queLock);
+
+    wakeRunTask();
+    return ESP_OK;
+}
+
+void Indication::getQueueStats(ind_queue_stats_t *stats)
+{
+    if (stats == nullptr)
+        return;
+
+    taskENTER_CRITICAL(&queLock);
+    *stats = queStats;
+    taskEXIT_CRITICAL(&queLock);
+    stats->ringDropped = ringDropped.load(std::memory_order_relaxed);
+}
+
+void Indication::resetQueueStats(void)
+{
+    taskENTER_CRITICAL(&queLock);
+    queStats = {};
+    taskEXIT_CRITICAL(&queLock);
+    ringDropped.store(0, std::memory_order_relaxed);
+}
+
+/* Pending Shadow */
+bool Indication::isCmdPending(const ind_cmd_t *cmd)
+{
+    bool found = false;
+
+    taskENTER_CRITICAL(&queLock);
+    for (uint8_t i = 0; i < quePendingCount; i++)
+    {
+        if ((quePending[i].value == cmd->value) && (quePending[i].priority == cmd->priority) && (quePending[i].flags == cmd->flags))
+        {
+            found = true;
+            break;
+        }
+    }
+    taskEXIT_CRITICAL(&queLock);
+    return found;
+}
+
+void Indication::addPendingCmd(const ind_cmd_t *cmd)
+{
+    taskENTER_CRITICAL(&queLock);
+    if (quePendingCount < (IND_PRIORITY_CLASSES * (CONFIG_WS2812_CMD_QUEUE_DEPTH + 1))) // One extra slot per class for the command being sent
+        quePending[quePendingCount++] = *cmd;
+    taskEXIT_CRITICAL(&queLock);
+}
+
+void Indication::forgetPendingCmd(const ind_cmd_t *cmd)
+{
+    taskENTER_CRITICAL(&queLock);
+    for (uint8_t i = 0; i < quePendingCount; i++)
+    {
+        if ((quePending[i].value == cmd->value) && (quePending[i].priority == cmd->priority) && (quePending[i].flags == cmd->flags))
+        {
+            quePending[i] = quePending[--quePendingCount]; // Order does not matter in the shadow
+            break;
+        }
+    }
+    taskEXIT_CRITICAL(&queLock);
+}
+
+/* Run Task Side */
+void Indication::wakeRunTask(void)
+{
+#if CONFIG_WS2812_SHARED_SCHEDULER
+    TaskHandle_t task = sharedTask;
+
+    if (task != nullptr)
+        xTaskNotifyGive(task); // The shared task sleeps on its notification, not on any one command queue
+#else
+    uint32_t wake = IND_CMD_WAKE;
+
+    if (runWaiting.exchange(false)) // Only the first submitter after the run task went to sleep rings
+        xQueueSendToFront(queHandleIndCmdRequest, &wake, 0); // A full queue means the run task has work anyway
+#endif
+}
+
+void Indication::postNotify(uint32_t bits)
+{
+#if CONFIG_WS2812_SHARED_SCHEDULER
+    sharedNotify.fetch_or(bits); // Kept per device, then the doorbell
+    wakeRunTask();
+#else
+    xTaskNotify(taskHandleRun, bits, eSetBits); // Bits merge with any pending value, so this never fails
+#endif
+}
+
+uint32_t Indication::takeNotify(void)
+{
+#if CONFIG_WS2812_SHARED_SCHEDULER
+    return sharedNotify.exchange(0);
+#else
+    return ulTaskNotifyTake(pdTRUE, 0);
+#endif
+}
+
+bool Indication::isShutdownPending(void)
+{
+    // Looks without taking, so the other bits are still handled when we next go idle
+#if CONFIG_WS2812_SHARED_SCHEDULER
+    return (sharedNotify.load() & static_cast<uint32_t>(IND_NOTIFY::CMD_SHUT_DOWN)) != 0;
+#else
+    return (ulTaskNotifyValueClear(NULL, 0) & static_cast<uint32_t>(IND_NOTIFY::CMD_SHUT_DOWN)) != 0; // Clearing no bits just reads our value
+#endif
+}
+
+bool Indication::fetchCmd(ind_cmd_t *cmd)
+{
+    // Highest class first.  Within a class, a preempted command goes ahead of queued ones because it was started earlier.
+    for (int8_t p = IND_PRIORITY_CLASSES - 1; p >= 0; p--)
+    {
+        if ((preemptedCount > 0) && ((int8_t)preempted[preemptedCount - 1].priority == p))
+        {
+            *cmd = preempted[--preemptedCount];
+            taskENTER_CRITICAL(&queLock);
+            queStats.resumed++;
+            taskEXIT_CRITICAL(&queLock);
+            return true;
+        }
+
+        if (xQueueReceive(queHandleIndPriority[p], cmd, 0) == pdTRUE)
+        {
+            forgetPendingCmd(cmd); // The command is no longer waiting
+            return true;
+        }
+
+        if (fetchPattern(p, cmd)) // Pattern ids come after full commands of the same class
+            return true;
+    }
+    return false;
+}
+
+bool Indication::isPreemptPending(void)
+{
+    if (isShutdownPending()) // Nothing is worth finishing once we are asked to shut down
+        return true;
+
+    if (activeCmd.flags & (CMD_Persistent | CMD_Version)) // Any one-shot command overlays the persistent pattern or the version flash
+    {
+        if (persistRequestPending || (uxQueueMessagesWaiting(queHandleIndCmdRequest) > 0))
+            return true;
+
+        for (uint8_t p = 0; p < IND_PRIORITY_CLASSES; p++)
+        {
+            if ((uxQueueMessagesWaiting(queHandleIndPriority[p]) > 0) || (uxQueueMessagesWaiting(queHandleIndPattern[p]) > 0))
+                return true;
+        }
+        return false;
+    }
+
+    for (uint8_t p = (uint8_t)activeCmd.priority + 1; p < IND_PRIORITY_CLASSES; p++)
+    {
+        if ((uxQueueMessagesWaiting(queHandleIndPriority[p]) > 0) || (uxQueueMessagesWaiting(queHandleIndPattern[p]) > 0))
+            return true;
+    }
+    return false;
+}
+
+void Indication::preemptIndication(void)
+{
+    if (progActive) // A program may have lit any channel
+        setAndClearColors(0, COLORA_Bit | COLORB_Bit | COLORC_Bit);
+    else
+        setAndClearColors(0, first_color_target | second_color_target); // Leave the LED dark before the next command starts
+
+    if (activeCmd.flags & (CMD_Persistent | CMD_Version)) // The persistent pattern simply starts over once the overlay is finished.  The version flash is just dropped.
+    {
+        resetIndication();
+        return;
+    }
+
+    taskENTER_CRITICAL(&queLock);
+    queStats.preempted++;
+    taskEXIT_CRITICAL(&queLock);
+
+    if ((preemptPolicy == IND_PREEMPT::Resume) && (preemptedCount < IND_PRIORITY_CLASSES)) // A blink code resumed halfway would be miscounted, so it replays from the start
+    {
+        if (activeCmd.ticket != nullptr)
+            signalTicket(activeCmd.ticket, IND_TICKET::Preempted);
+        preempted[preemptedCount++] = activeCmd;
+    }
+    else
+    {
+        taskENTER_CRITICAL(&queLock);
+        queStats.discarded++;
+        taskEXIT_CRITICAL(&queLock);
+
+        if (activeCmd.ticket != nullptr)
+            signalTicket(activeCmd.ticket, IND_TICKET::Discarded);
+    }
+    activeCmd.ticket = nullptr;
+
+    resetIndication(); // The RMT driver stays up for the command that follows
+}
+
+void Indication::applyPersistentRequest(void)
+{
+    esp_err_t ret = ESP_OK;
+    uint32_t request = IND_CMD_WAKE;
+    bool pending = false;
+
+    taskENTER_CRITICAL(&queLock);
+    pending = persistRequestPending;
+    request = persistRequest;
+    persistRequestPending = false;
+    taskEXIT_CRITICAL(&queLock);
+
+    if (!pending || (request == persistValue))
+        return;
+
+    persistValue = request;
+
+    if (IsIndicating && (activeCmd.flags & CMD_Persistent)) // Replaced or cancelled while showing -- stop the old pattern now
+    {
+        setAndClearColors(0, first_color_target | second_color_target);
+        resetIndication();
+    }
+
+    if (!isDriverHeld() && !IsIndicating && rmtEstablished) // Nothing left to repeat, so let the driver go
+        ESP_GOTO_ON_ERROR(demolishRMTDriver(), ind_applyPersistentRequest_err, TAG, "demolishRMTDriver() failed");
+    return;
+
+ind_applyPersistentRequest_err:
+    errFunc = __func__;
+    errCode = ret;
+    indOP = IND_OP::Error;
+}
@@ -0,0 +1,104 @@
+#include "indication/indication_.hpp"
+
+//
+// submitIndicationFromISR() is a lock-free path into the component for interrupt handlers (it is safe from tasks as well).
+// It is a bounded multi-producer, single-consumer ring.  Each slot carries a sequence number:
+//
+//   seq == pos      the slot is free for the producer who claims position pos
+//   seq == pos + 1  the slot holds a command for the consumer at position pos
+//
+// A producer claims a position with one compare and swap, fills the slot and publishes it by storing the sequence number.
+// The run task is the only consumer.  It moves ring commands into the priority class queues, where the normal priority and
+// preemption rules apply.  The only kernel call on this path is the wake, made the same way wakeRunTask() makes it: a wake word
+// when our own run task is asleep on the command queue, or a direct notification of the shared task, which sleeps on its
+// notification instead.
+//
+static_assert((CONFIG_WS2812_ISR_RING_DEPTH & (CONFIG_WS2812_ISR_RING_DEPTH - 1)) == 0, "CONFIG_WS2812_ISR_RING_DEPTH must be a power of 2");
+
+#define IND_RING_MASK (CONFIG_WS2812_ISR_RING_DEPTH - 1)
+
+/* ISR Ring */
+esp_err_t IRAM_ATTR Indication::submitIndicationFromISR(uint32_t value, IND_PRIORITY priority, BaseType_t *pxHigherPriorityTaskWoken)
+{
+    uint32_t pos = 0;
+    ind_ring_slot_t *slot = nullptr;
+#if CONFIG_WS2812_SHARED_SCHEDULER
+    TaskHandle_t task = nullptr;
+#else
+    uint32_t wake = IND_CMD_WAKE;
+#endif
+
+    if (((uint8_t)priority >= IND_PRIORITY_CLASSES) || (value == IND_CMD_WAKE))
+        return ESP_ERR_INVALID_ARG; // No logging from interrupt context
+
+    pos = ringEnqueuePos.load(std::memory_order_relaxed);
+
+    while (true)
+    {
+        slot = &ring[pos & IND_RING_MASK];
+        int32_t diff = (int32_t)(slot->seq.load(std::memory_order_acquire) - pos);
+
+        if (diff == 0) // Slot is free at our position -- try to claim it
+        {
+            if (ringEnqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                break;
+        }
+        else if (diff < 0) // The consumer has not freed this slot yet, so the ring is full
+        {
+            ringDropped.fetch_add(1, std::memory_order_relaxed);
+            return ESP_ERR_TIMEOUT;
+        }
+        else
+            pos = ringEnqueuePos.load(std::memory_order_relaxed); // Another producer got here first
+    }
+
+    slot->cmd = {value, priority, 0};
+    slot->seq.store(pos + 1, std::memory_order_release); // Publish to the consumer
+
+#if CONFIG_WS2812_SHARED_SCHEDULER
+    task = sharedTask;
+    if (task != nullptr)
+        vTaskNotifyGiveFromISR(task, pxHigherPriorityTaskWoken); // The shared task never waits on our command queue
+#else
+    if (runWaiting.exchange(false)) // Kernel call only when the run task sleeps on the command queue
+        xQueueSendToFrontFromISR(queHandleIndCmdRequest, &wake, pxHigherPriorityTaskWoken);
+#endif
+
+    return ESP_OK;
+}
+
+void Indication::initIsrRing(void)
+{
+    for (uint32_t i = 0; i < CONFIG_WS2812_ISR_RING_DEPTH; i++)
+        ring[i].seq.store(i, std::memory_order_relaxed);
+
+    ringEnqueuePos.store(0, std::memory_order_relaxed);
+    ringDequeuePos = 0;
+}
+
+void Indication::drainIsrRing(void)
+{
+    ind_cmd_t cmd = {};
+    ind_ring_slot_t *slot = nullptr;
+
+    std::atomic_thread_fence(std::memory_order_seq_cst); // Pairs with runWaiting so a producer either sees us waiting or we see its slot
+
+    while (true)
+    {
+        slot = &ring[ringDequeuePos & IND_RING_MASK];
+
+        if (slot->seq.load(std::memory_order_acquire) != (ringDequeuePos + 1)) // Nothing published at our position
+            break;
+
+        cmd = slot->cmd;
+        slot->seq.store(ringDequeuePos + CONFIG_WS2812_ISR_RING_DEPTH, std::memory_order_release); // Free the slot for the next lap
+        ringDequeuePos++;
+
+        if (xQueueSendToBack(queHandleIndPriority[(uint8_t)cmd.priority], &cmd, 0) != pdTRUE)
+        {
+            taskENTER_CRITICAL(&queLock);
+            queStats.ringOverflow++;
+            taskEXIT_CRITICAL(&queLock);
+        }
+    }
+}
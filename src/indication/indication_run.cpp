@@ -7,459 +7,523 @@
 /* External Semaphores */
 extern SemaphoreHandle_t semIndEntry;
 
+#if CONFIG_WS2812_STATIC_ALLOCATION && !CONFIG_WS2812_SHARED_SCHEDULER
+//
+// Static run tasks live in static memory, not in the object.  A task can only be deleted safely once it is off the CPU, and
+// nothing in FreeRTOS tells another task when that has happened.  So a task is never deleted.  It gives semIndJoin like a
+// dynamic run task and then waits for the next object to serve, the way the static shared task waits for its next device.
+//
+typedef struct
+{
+    Indication *dev; // Object being served.  nullptr while the slot is free.
+    TaskHandle_t task;
+    SemaphoreHandle_t semStart; // Given by claimRunTask() to hand the task its next object
+    StaticSemaphore_t semStartBuffer;
+    StaticTask_t taskBuffer;
+    StackType_t stack[IND_STACK_WORDS];
+} ind_run_slot_t;
+
+static ind_run_slot_t runSlots[CONFIG_WS2812_STATIC_RUN_TASKS] = {};
+static portMUX_TYPE runSlotLock = portMUX_INITIALIZER_UNLOCKED;
+
+esp_err_t Indication::claimRunTask(void)
+{
+    ind_run_slot_t *slot = nullptr;
+
+    taskENTER_CRITICAL(&runSlotLock);
+    for (uint8_t i = 0; i < CONFIG_WS2812_STATIC_RUN_TASKS; i++)
+    {
+        if (runSlots[i].dev == nullptr)
+        {
+            slot = &runSlots[i];
+            slot->dev = this;
+            break;
+        }
+    }
+    taskEXIT_CRITICAL(&runSlotLock);
+
+    ESP_RETURN_ON_FALSE(slot, ESP_ERR_NO_MEM, TAG, "no free static run task");
+
+    if (slot->task == nullptr) // Created on first use and kept for good
+    {
+        slot->semStart = xSemaphoreCreateBinaryStatic(&slot->semStartBuffer);
+        slot->task = xTaskCreateStatic(runMarshaller, "ind_run", IND_STACK_WORDS, slot, TASK_PRIORITY_LOW, slot->stack, &slot->taskBuffer); // Never fails
+    }
+
+    taskHandleRun = slot->task;
+    xSemaphoreGive(slot->semStart);
+    return ESP_OK;
+}
+#endif
+
+static uint8_t scalePaletteLevel(uint8_t level, uint8_t setLevel)
+{
+    // A palette level is dimmed by the channel set level, so brightness settings apply to palette colors too.  A channel the
+    // palette lights is never rounded down to dark while its set level is above zero.
+    uint8_t scaled = (uint8_t)(((uint16_t)level * setLevel + 127) / 255);
+
+    if ((scaled == 0) && (level > 0) && (setLevel > 0))
+        scaled = 1;
+    return scaled;
+}
+
 void Indication::runMarshaller(void *arg)
 {
-    ((Indication *)arg)->run();
-    ((Indication *)arg)->taskHandleRun = nullptr; // This doesn't happen automatically but we look at this variable for validity, so set it manually.
+#if CONFIG_WS2812_STATIC_ALLOCATION && !CONFIG_WS2812_SHARED_SCHEDULER
+    ind_run_slot_t *slot = (ind_run_slot_t *)arg;
+    Indication *ind = nullptr;
+
+    while (true) // Our stack is static memory, so we wait for the next object instead of deleting ourselves
+    {
+        xSemaphoreTake(slot->semStart, portMAX_DELAY);
+        ind = slot->dev;
+
+        ind->run();
+        ind->taskHandleRun = nullptr;           // This doesn't happen automatically but we look at this variable for validity, so set it manually.
+        ulTaskNotifyValueClear(NULL, UINT32_MAX); // Bits left for this object mean nothing to the next one
+
+        taskENTER_CRITICAL(&runSlotLock);
+        slot->dev = nullptr; // A new object may claim us now.  We only start it once we take semStart again.
+        taskEXIT_CRITICAL(&runSlotLock);
+
+        xSemaphoreGive(ind->semIndJoin); // Releases the destructor.  We must not touch the object after this.
+    }
+#else
+    Indication *ind = (Indication *)arg;
+
+    ind->run();
+    ind->taskHandleRun = nullptr;   // This doesn't happen automatically but we look at this variable for validity, so set it manually.
+    xSemaphoreGive(ind->semIndJoin); // Releases the destructor.  We must not touch the object after this.
     vTaskDelete(NULL);
+#endif
 }
 
 void Indication::run(void)
 {
-    esp_err_t ret = ESP_OK;
-
-    uint8_t cycles = 0;
-    uint32_t value = 0;
+    resetIndication();
 
-    TickType_t startDwellTime = 0;
+    while (runPass())
+    {
+        publishSnapshot(); // Readers see the outcome of this pass
+        taskYIELD();
+    }
+}
 
-    // We want our dwell time to be about 10mSecs.  When the RTOS tick rate is 100Hz, our dwellTime ticks are only 1.
-    // If we should increase our tick rate upward, we will want to automatically calculate a new tick dwellTime.
-    TickType_t dwellTime = pdMS_TO_TICKS(10);
-    // ESP_LOGW(TAG, "dwellTime is %ldmSec with %d ticks", pdTICKS_TO_MS(dwellTime), dwellTime); // Verfication during development only
+TickType_t Indication::idleWaitTicks(void)
+{
+    if (persistValue != IND_CMD_WAKE) // The persistent pattern plays again right away
+        return 0;
+    return ticksUntilNextRelease(ditherPending ? pdMS_TO_TICKS(IND_DWELL_US / 1000) : pdMS_TO_TICKS(245));
+}
 
-    resetIndication();
+bool Indication::runPass(void)
+{
+    // One pass of our state machine.  Our own run task loops on this, or the shared scheduler calls it for every device.
+    esp_err_t ret = ESP_OK;
+    uint32_t value = 0;
 
-    while (true)
+    switch (indOP)
     {
-        switch (indOP)
-        {
-        case IND_OP::Run: // When NOT indicating, we would like to achieve about a 4Hz entry cadence in the Run state.
+    case IND_OP::Run: // When NOT indicating, we would like to achieve about a 4Hz entry cadence in the Run state.
+    {
+        applyPersistentRequest(); // Pick up a new, replaced or cancelled persistent pattern
+
+        if (IsIndicating) // The priority is the do the indication.  We can only perform one indication at a time.
         {
-            if (IsIndicating) // The priority is the do the indication.  We can only perform one indication at a time.
-            {
-                startDwellTime = xTaskGetTickCount();
-                xTaskDelayUntil(&startDwellTime, dwellTime);
+            waitDwell(); // One dwell step (IND_DWELL_US) from the chosen timing source
+#if CONFIG_WS2812_DITHER
+            stepHadFrame = false;
+#endif
 
-                switch (indState)
-                {
-                case IND_STATES::Idle:
-                {
-                    break;
-                }
+            drainIsrRing();         // Interrupt submissions join their class queues before we look for preemption
+            releaseDueCmds();       // So do scheduled commands whose time has come
+            applyChannelSettings(); // Published settings take effect mid-indication as well
 
-                case IND_STATES::Clear_FirstColor:
-                {
-                    if ((first_on_time_counter > 0) && (--first_on_time_counter < 1)) // First color on-time just expired
-                    {
-                        setAndClearColors(0, first_color_target); // Turn off the first color
-                        indState = IND_STATES::Set_FirstColor;    // Assume that a first color has another cycle by default
+            if (isPreemptPending()) // A higher priority command is waiting.  This leaves us in the Idle state.
+                preemptIndication();
 
-                        if (first_color_cycles < 1)
-                        {
-                            if (second_color_target < 1)
-                                off_time_counter = 3 * off_time; // IF we are finished with the first color AND we don't have a second color THEN add extra off delay time.
-                            else
-                            {
-                                off_time_counter = 2 * off_time; // Moving to second color off delay time.
-                                indState = IND_STATES::Set_SecondColor;
-                            }
-                        }
-                        else
-                            off_time_counter = off_time; // Normal off delay time between color one cycles
-                    }
-                    break;
-                }
+            switch (indState)
+            {
+            case IND_STATES::Idle:
+            {
+                break;
+            }
 
-                case IND_STATES::Clear_SecondColor:
+            case IND_STATES::Clear_FirstColor:
+            {
+                if ((first_on_time_counter > 0) && (--first_on_time_counter < 1)) // First color on-time just expired
                 {
-                    if ((second_on_time_counter > 0) && (--second_on_time_counter < 1)) // Second color on-time just expired
-                    {
-                        setAndClearColors(0, second_color_target); // Turn off the second color
-                        indState = IND_STATES::Set_SecondColor;    // Assume that a second color has another cycle by default
+                    setAndClearColors(0, first_color_target); // Turn off the first color
+                    indState = IND_STATES::Set_FirstColor;    // Assume that a first color has another cycle by default
 
-                        if (second_color_cycles < 1)         // If we are finished with the second color -- add extra delay time
-                            off_time_counter = 3 * off_time; // If we are finish then add extra delay time between this code and one that might come next.
-                        else
-                            off_time_counter = off_time; // Normal off-time.
-                    }
-                    break;
-                }
-
-                case IND_STATES::Set_FirstColor:
-                case IND_STATES::Set_SecondColor:
-                {
-                    if ((off_time_counter > 0) && (--off_time_counter < 1))
+                    if (first_color_cycles < 1)
                     {
-                        if ((first_color_cycles > 0) && (indState == IND_STATES::Set_FirstColor))
-                        {
-                            first_color_cycles--;
-                            setAndClearColors(first_color_target, 0); // Turn on the LED
-                            first_on_time_counter = on_time;
-                            indState = IND_STATES::Clear_FirstColor;
-                        }
-                        else if ((second_color_cycles > 0) && (indState == IND_STATES::Set_SecondColor))
-                        {
-                            second_color_cycles--;
-                            setAndClearColors(second_color_target, 0); // Turn on the LED
-                            second_on_time_counter = on_time;
-                            indState = IND_STATES::Clear_SecondColor;
-                        }
+                        if (second_color_target < 1)
+                            off_time_counter = 3 * off_time; // IF we are finished with the first color AND we don't have a second color THEN add extra off delay time.
                         else
                         {
-                            indState = IND_STATES::Final;
+                            off_time_counter = 2 * off_time; // Moving to second color off delay time.
+                            indState = IND_STATES::Set_SecondColor;
                         }
                     }
-                    break;
+                    else
+                        off_time_counter = off_time; // Normal off delay time between color one cycles
                 }
+                break;
+            }
 
-                case IND_STATES::Final:
+            case IND_STATES::Clear_SecondColor:
+            {
+                if ((second_on_time_counter > 0) && (--second_on_time_counter < 1)) // Second color on-time just expired
                 {
-                    if (rmtEstablished)
-                        ESP_GOTO_ON_ERROR(demolishRMTDriver(), ind_final_err, TAG, "demolishRMTDriver() failed");
-                    resetIndication(); // Resetting all the indicator variables
-                    break;
+                    setAndClearColors(0, second_color_target); // Turn off the second color
+                    indState = IND_STATES::Set_SecondColor;    // Assume that a second color has another cycle by default
 
-                ind_final_err:
-                    errMsg = std::string(__func__) + "(): " + esp_err_to_name(ret);
-                    indOP = IND_OP::Error;
-                    break;
-                }
+                    if (second_color_cycles < 1)         // If we are finished with the second color -- add extra delay time
+                        off_time_counter = 3 * off_time; // If we are finish then add extra delay time between this code and one that might come next.
+                    else
+                        off_time_counter = off_time; // Normal off-time.
                 }
+                break;
             }
-            else // When we are not indicating -- we are looking for notifications or incoming commands.
-            {
-                indTaskNotifyValue = static_cast<IND_NOTIFY>(ulTaskNotifyTake(pdTRUE, 0)); // This is a rare command so we don't wait here.
 
-                if (indTaskNotifyValue > static_cast<IND_NOTIFY>(0))
+            case IND_STATES::Set_FirstColor:
+            case IND_STATES::Set_SecondColor:
+            {
+                if ((off_time_counter > 0) && (--off_time_counter < 1))
                 {
-                    // ESP_LOGW(TAG, "Task notification Colors 0x%02X  Value is %d", ((((int)indTaskNotifyValue) & 0xFFFFFF00) >> 8), (int)indTaskNotifyValue & 0x000000FF);
-
-                    if ((int)indTaskNotifyValue & (int)IND_NOTIFY::NFY_SET_A_COLOR_BRIGHTNESS)
-                    {
-                        aSetLevel = (int)indTaskNotifyValue & 0x000000FF;
-                        startNVSDelayTicks = xTaskGetTickCount();
-                    }
-                    else if ((int)indTaskNotifyValue & (int)IND_NOTIFY::NFY_SET_B_COLOR_BRIGHTNESS)
+                    if ((first_color_cycles > 0) && (indState == IND_STATES::Set_FirstColor))
                     {
-                        bSetLevel = (int)indTaskNotifyValue & 0x000000FF;
-                        startNVSDelayTicks = xTaskGetTickCount();
+                        first_color_cycles--;
+                        setAndClearColors(first_color_target, 0, firstUsesPalette ? firstPalette : nullptr); // Turn on the LED
+                        first_on_time_counter = on_time;
+                        indState = IND_STATES::Clear_FirstColor;
                     }
-                    else if ((int)indTaskNotifyValue & (int)IND_NOTIFY::NFY_SET_C_COLOR_BRIGHTNESS)
+                    else if ((second_color_cycles > 0) && (indState == IND_STATES::Set_SecondColor))
                     {
-                        cSetLevel = (int)indTaskNotifyValue & 0x000000FF;
-                        startNVSDelayTicks = xTaskGetTickCount();
+                        second_color_cycles--;
+                        setAndClearColors(second_color_target, 0, secondUsesPalette ? secondPalette : nullptr); // Turn on the LED
+                        second_on_time_counter = on_time;
+                        indState = IND_STATES::Clear_SecondColor;
                     }
-                    else if ((int)indTaskNotifyValue & (int)IND_NOTIFY::CMD_SHUT_DOWN)
+                    else
                     {
-                        indShdnStep = IND_SHUTDOWN::Start;
-                        indOP = IND_OP::Shutdown;
-                        break;
+                        indState = IND_STATES::Final;
                     }
-                    else
-                        routeLogByValue(LOG_TYPE::ERROR, std::string(__func__) + "(): Error, Unhandled TaskNotification");
-                }
-                else if (xQueueReceive(queHandleIndCmdRequest, (void *)&value, pdMS_TO_TICKS(245)) == pdTRUE) // We can wait here most of the time for requests
-                {
-                    // ESP_LOGW(TAG, "Received notification value of %08X", (int)value);
-                    startIndication(value); // We have an indication value
                 }
+                break;
             }
 
-            // Even if we are indicating, we may want to perform some background work.  We can do that here.
-
-            if (startNVSDelayTicks > 0) // If we in the process of counting time (ticks)
+            case IND_STATES::Program:
             {
-                if (xTaskGetTickCount() > (startNVSDelayTicks + mSecNVSDelayTicks))
-                {
-                    saveVariablesToNVS();
-                    routeLogByValue(LOG_TYPE::WARN, std::string(__func__) + "(): saveVariablesToNVS()");
-                    startNVSDelayTicks = 0; // Stop the count for NVS storage
-                }
+                stepProgram();
+                break;
             }
-            break;
-        }
 
-        case IND_OP::Shutdown:
-        {
-            // Positionally, it is important for Shutdown to be serviced right after it is called.  We don't want other possible operations becoming active unexepectedly.
-            // A shutdown is a complete undoing of all items that were established or created with our run thread.
-            // If we are connected then disconnect.  If we created resources (after construction), we must dispose of them here.
-            switch (indShdnStep)
-            {
-            case IND_SHUTDOWN::Start:
+            case IND_STATES::Final:
             {
-                if (showIND & _showINDShdnSteps)
-                    routeLogByValue(LOG_TYPE::INFO, std::string(__func__) + "(): IND_SHUTDOWN::Start");
+                if (progActive) // A classic command inside a program is done.  The program carries on at the next step.
+                {
+                    indState = IND_STATES::Program;
+                    break;
+                }
 
-                if (rmtEstablished)
-                    indShdnStep = IND_SHUTDOWN::DisableAndDeleteRMTChannel;
-                else
-                    indShdnStep = IND_SHUTDOWN::Final_Items;
-                break;
-            }
+                if (rmtEstablished && !isDriverHeld()) // A persistent pattern repeats soon, or dithered levels need refreshing, so we may keep the driver
+                    ESP_GOTO_ON_ERROR(demolishRMTDriver(), ind_final_err, TAG, "demolishRMTDriver() failed");
 
-            case IND_SHUTDOWN::DisableAndDeleteRMTChannel:
-            {
-                if (showIND & _showINDShdnSteps)
-                    routeLogByValue(LOG_TYPE::INFO, std::string(__func__) + "(): IND_SHUTDOWN::DisableAndDeleteRMTChannel - Step " + std::to_string((int)IND_SHUTDOWN::DisableAndDeleteRMTChannel));
+                if (activeCmd.ticket != nullptr)
+                    signalTicket(activeCmd.ticket, IND_TICKET::Finished);
+                activeCmd.ticket = nullptr;
 
-                if (rmtEstablished)
-                    ESP_GOTO_ON_ERROR(demolishRMTDriver(), ind_disableAndDeleteRMTChannel_err, TAG, "demolishRMTDriver() failed");
-                indShdnStep = IND_SHUTDOWN::Final_Items;
+                resetIndication(); // Resetting all the indicator variables
                 break;
 
-            ind_disableAndDeleteRMTChannel_err:
-                errMsg = std::string(__func__) + "(): " + esp_err_to_name(ret);
+            ind_final_err:
+                errFunc = __func__;
+                errCode = ret;
                 indOP = IND_OP::Error;
                 break;
             }
-
-            case IND_SHUTDOWN::Final_Items:
-            {
-                if (showIND & _showINDShdnSteps)
-                    routeLogByValue(LOG_TYPE::INFO, std::string(__func__) + "(): IND_SHUTDOWN::Final_Items - Step " + std::to_string((int)IND_SHUTDOWN::Final_Items));
-
-                indShdnStep = IND_SHUTDOWN::Finished;
-                break;
             }
 
-            case IND_SHUTDOWN::Finished:
-            {
-                if (showIND & _showINDShdnSteps)
-                    routeLogByValue(LOG_TYPE::INFO, std::string(__func__) + "(): IND_SHUTDOWN::Finished");
-                return; // This exits the run function. (notice how the compiler doesn't complain about the missing break statement)
-            }
-            }
-            break;
+#if CONFIG_WS2812_DITHER
+            if (IsIndicating && !stepHadFrame && (indOP == IND_OP::Run)) // A dimmed blink holds a fractional level between edges too
+                refreshDither();
+#endif
         }
-
-        case IND_OP::Init:
+        else // When we are not indicating -- we are looking for notifications or incoming commands.
         {
-            switch (indInitStep)
+            stopDwell(); // No edges to pace while idle
+#if CONFIG_WS2812_DITHER
+            refreshDither(); // Fractional levels need a fresh frame on every pass
+#endif
+            compositeLayers(); // Only does work when a layer changed or an indication covered them
+            indTaskNotifyValue = static_cast<IND_NOTIFY>(takeNotify()); // This is a rare command so we don't wait here.
+
+            if (indTaskNotifyValue > static_cast<IND_NOTIFY>(0))
             {
-            case IND_INIT::Start:
-            {
-                if (show & _showInit)
-                    routeLogByValue(LOG_TYPE::INFO, std::string(__func__) + "(): IND_INIT::Start");
+                // ESP_LOGW(TAG, "Task notification Colors 0x%02X  Value is %d", ((((int)indTaskNotifyValue) & 0xFFFFFF00) >> 8), (int)indTaskNotifyValue & 0x000000FF);
 
-                indInitStep = IND_INIT::StartRMTDriver;
-                [[fallthrough]];
-            }
-
-            case IND_INIT::StartRMTDriver:
-            {
-                if (show & _showInit)
-                    routeLogByValue(LOG_TYPE::INFO, std::string(__func__) + "(): IND_INIT::StartRMTDriver - Step " + std::to_string((int)IND_INIT::StartRMTDriver));
-
-                if (!rmtEstablished)
-                    ESP_GOTO_ON_ERROR(establishRMTDriver(), ind_startRMTDriver_err, TAG, "establishRMTDriver() failed");
-                indInitStep = IND_INIT::Set_LED_Initial_States;
-                break;
-
-            ind_startRMTDriver_err:
-                errMsg = std::string(__func__) + "(): " + esp_err_to_name(ret);
-                indOP = IND_OP::Error;
-                break;
-            }
+                // Every bit is handled on its own.  One notification may carry several colors and a settings bit may be merged in.
+                if ((int)indTaskNotifyValue & (int)IND_NOTIFY::NFY_SET_A_COLOR_BRIGHTNESS)
+                {
+                    aSetLevel = (int)indTaskNotifyValue & 0x000000FF;
+                    startNVSDelayTicks = xTaskGetTickCount();
+                }
 
-            case IND_INIT::Set_LED_Initial_States:
-            {
-                if (show & _showInit)
-                    routeLogByValue(LOG_TYPE::INFO, std::string(__func__) + "(): IND_INIT::Set_LED_Initial_States - Step " + std::to_string((int)IND_INIT::Set_LED_Initial_States));
+                if ((int)indTaskNotifyValue & (int)IND_NOTIFY::NFY_SET_B_COLOR_BRIGHTNESS)
+                {
+                    bSetLevel = (int)indTaskNotifyValue & 0x000000FF;
+                    startNVSDelayTicks = xTaskGetTickCount();
+                }
 
-                if (aState == LED_STATE::ON) // Now that the RMT driver has been initialized, we just need to set Color channels according to their States.
-                    setAndClearColors(COLORA_Bit, 0);
-                else
-                    setAndClearColors(0, COLORA_Bit);
+                if ((int)indTaskNotifyValue & (int)IND_NOTIFY::NFY_SET_C_COLOR_BRIGHTNESS)
+                {
+                    cSetLevel = (int)indTaskNotifyValue & 0x000000FF;
+                    startNVSDelayTicks = xTaskGetTickCount();
+                }
 
-                if (bState == LED_STATE::ON)
-                    setAndClearColors(COLORB_Bit, 0);
-                else
-                    setAndClearColors(0, COLORB_Bit);
+                if ((int)indTaskNotifyValue & (int)IND_NOTIFY::NFY_APPLY_SETTINGS)
+                    applyChannelSettings();
 
-                if (cState == LED_STATE::ON)
-                    setAndClearColors(COLORC_Bit, 0);
-                else
-                    setAndClearColors(0, COLORC_Bit);
+                if ((int)indTaskNotifyValue & (int)IND_NOTIFY::CMD_SHUT_DOWN)
+                {
+                    indShdnStep = IND_SHUTDOWN::Start;
+                    indOP = IND_OP::Shutdown;
+                    break;
+                }
 
-                indInitStep = IND_INIT::Early_Release;
-                break;
+                if (!((int)indTaskNotifyValue & ((int)IND_NOTIFY::NFY_SET_A_COLOR_BRIGHTNESS | (int)IND_NOTIFY::NFY_SET_B_COLOR_BRIGHTNESS | (int)IND_NOTIFY::NFY_SET_C_COLOR_BRIGHTNESS | (int)IND_NOTIFY::NFY_APPLY_SETTINGS)))
+                    routeLogByValue(LOG_TYPE::ERROR, "%s(): Error, Unhandled TaskNotification", __func__);
             }
-
-            case IND_INIT::Early_Release:
+            else
             {
-                if (show & _showInit)
-                    routeLogByValue(LOG_TYPE::INFO, std::string(__func__) + "(): IND_INIT::Early_Release - Step " + std::to_string((int)IND_INIT::Early_Release));
-
-                // In the event that no one else is using the LED for any kind of indication during initialization, the object can release it's locking semaphore early.
-                xSemaphoreGive(semIndEntry);
-
-                // If any colors are in the On state, or if ALL colors are in the Off state, then bypass the Flashing of the version numbers.
-                if ((aState == LED_STATE::ON) || (bState == LED_STATE::ON) || (cState == LED_STATE::ON))
-                    indInitStep = IND_INIT::Finished;
-                else if ((aState == LED_STATE::OFF) && (bState == LED_STATE::OFF) && (cState == LED_STATE::OFF))
-                    indInitStep = IND_INIT::Finished;
-                else
+                runWaiting = true; // Announce this before looking, so a submitter who races us will still wake us
+
+                drainIsrRing();
+                releaseDueCmds();
+                if (fetchCmd(&activeCmd)) // Priority class queues and preempted commands come first
+                    startCommand();
+#if CONFIG_WS2812_SHARED_SCHEDULER
+                else if (xQueueReceive(queHandleIndCmdRequest, (void *)&value, 0) == pdTRUE) // The shared task does the waiting for all devices
+#else
+                else if (xQueueReceive(queHandleIndCmdRequest, (void *)&value, idleWaitTicks()) == pdTRUE) // We can wait here most of the time for requests
+#endif
                 {
-                    cycles = majorVer;
-
-                    if (cycles > 0)
-                        indInitStep = IND_INIT::ColorA_On;
-                    else
-                        indInitStep = IND_INIT::ColorA_Off;
+                    // ESP_LOGW(TAG, "Received notification value of %08X", (int)value);
+                    if (value != IND_CMD_WAKE) // A wake word only brings us back to look at the class queues
+                    {
+                        activeCmd = {value, IND_PRIORITY::Routine}; // Raw queue senders are Routine
+                        startCommand();                             // We have an indication value
+                    }
                 }
-                break;
+                else if (persistValue != IND_CMD_WAKE) // Nothing else to show, so the persistent pattern plays again
+                {
+                    activeCmd = {persistValue, IND_PRIORITY::Routine, CMD_Persistent};
+                    startCommand();
+                }
+
+                runWaiting = false;
             }
+        }
 
-            case IND_INIT::ColorA_On:
-            {
-                if (show & _showInit)
-                    routeLogByValue(LOG_TYPE::INFO, std::string(__func__) + "(): IND_INIT::ColorA_On - Step " + std::to_string((int)IND_INIT::ColorA_On));
+        // Even if we are indicating, we may want to perform some background work.  We can do that here.
 
-                cycles--;
-                setAndClearColors((uint8_t)COLORA_Bit, 0);
-                vTaskDelay(pdMS_TO_TICKS(100));
-                indInitStep = IND_INIT::ColorA_Off;
-                break;
+        if (startNVSDelayTicks > 0) // If we in the process of counting time (ticks)
+        {
+            if (xTaskGetTickCount() > (startNVSDelayTicks + mSecNVSDelayTicks))
+            {
+                saveVariablesToNVS();
+                routeLogByValue(LOG_TYPE::WARN, "%s(): saveVariablesToNVS()", __func__);
+                startNVSDelayTicks = 0; // Stop the count for NVS storage
             }
+        }
+        break;
+    }
 
-            case IND_INIT::ColorA_Off:
-            {
-                if (show & _showInit)
-                    routeLogByValue(LOG_TYPE::INFO, std::string(__func__) + "(): IND_INIT::ColorA_Off - Step " + std::to_string((int)IND_INIT::ColorA_Off));
+    case IND_OP::Shutdown:
+    {
+        // Positionally, it is important for Shutdown to be serviced right after it is called.  We don't want other possible operations becoming active unexepectedly.
+        // A shutdown is a complete undoing of all items that were established or created with our run thread.
+        // If we are connected then disconnect.  If we created resources (after construction), we must dispose of them here.
+        switch (indShdnStep)
+        {
+        case IND_SHUTDOWN::Start:
+        {
+            if (showIND & _showINDShdnSteps)
+                routeLogByValue(LOG_TYPE::INFO, "%s(): IND_SHUTDOWN::Start", __func__);
 
-                setAndClearColors(0, (uint8_t)COLORA_Bit);
-                vTaskDelay(pdMS_TO_TICKS(150));
+            if (rmtEstablished || (led_chan != NULL)) // A held driver keeps its channel while idle
+                indShdnStep = IND_SHUTDOWN::DisableAndDeleteRMTChannel;
+            else
+                indShdnStep = IND_SHUTDOWN::Final_Items;
+            break;
+        }
 
-                if (cycles > 0)
-                    indInitStep = IND_INIT::ColorA_On;
-                else
-                {
-                    cycles = minorVer;
+        case IND_SHUTDOWN::DisableAndDeleteRMTChannel:
+        {
+            if (showIND & _showINDShdnSteps)
+                routeLogByValue(LOG_TYPE::INFO, "%s(): IND_SHUTDOWN::DisableAndDeleteRMTChannel - Step %d", __func__, (int)IND_SHUTDOWN::DisableAndDeleteRMTChannel);
 
-                    if (cycles > 0)
-                        indInitStep = IND_INIT::ColorB_On;
-                    else
-                        indInitStep = IND_INIT::ColorB_Off;
+            if (rmtEstablished)
+                ESP_GOTO_ON_ERROR(demolishRMTDriver(), ind_disableAndDeleteRMTChannel_err, TAG, "demolishRMTDriver() failed");
+            ESP_GOTO_ON_ERROR(releaseRMTDriver(), ind_disableAndDeleteRMTChannel_err, TAG, "releaseRMTDriver() failed"); // A held driver is only disabled by the line above
+            indShdnStep = IND_SHUTDOWN::Final_Items;
+            break;
 
-                    vTaskDelay(pdMS_TO_TICKS(250)); // Off Time
-                }
-                break;
-            }
+        ind_disableAndDeleteRMTChannel_err:
+            errFunc = __func__;
+            errCode = ret;
+            indOP = IND_OP::Error;
+            break;
+        }
 
-            case IND_INIT::ColorB_On:
-            {
-                if (show & _showInit)
-                    routeLogByValue(LOG_TYPE::INFO, std::string(__func__) + "(): IND_INIT::ColorB_On - Step " + std::to_string((int)IND_INIT::ColorB_On));
+        case IND_SHUTDOWN::Final_Items:
+        {
+            if (showIND & _showINDShdnSteps)
+                routeLogByValue(LOG_TYPE::INFO, "%s(): IND_SHUTDOWN::Final_Items - Step %d", __func__, (int)IND_SHUTDOWN::Final_Items);
 
-                cycles--;
-                setAndClearColors((uint8_t)COLORB_Bit, 0);
-                vTaskDelay(pdMS_TO_TICKS(100));
-                indInitStep = IND_INIT::ColorB_Off;
-                break;
-            }
+            dropWaitingCmds(); // Nobody is left to show them, so their tickets are closed
 
-            case IND_INIT::ColorB_Off:
-            {
-                if (show & _showInit)
-                    routeLogByValue(LOG_TYPE::INFO, std::string(__func__) + "(): IND_INIT::ColorB_Off - Step " + std::to_string((int)IND_INIT::ColorB_Off));
+            indShdnStep = IND_SHUTDOWN::Finished;
+            break;
+        }
 
-                setAndClearColors(0, (uint8_t)COLORB_Bit);
-                vTaskDelay(pdMS_TO_TICKS(150));
+        case IND_SHUTDOWN::Finished:
+        {
+            if (showIND & _showINDShdnSteps)
+                routeLogByValue(LOG_TYPE::INFO, "%s(): IND_SHUTDOWN::Finished", __func__);
+            return false; // This ends our passes. (notice how the compiler doesn't complain about the missing break statement)
+        }
+        }
+        break;
+    }
 
-                if (cycles > 0) //
-                    indInitStep = IND_INIT::ColorB_On;
-                else
-                {
-                    cycles = patchNumber;
+    case IND_OP::Init:
+    {
+        switch (indInitStep)
+        {
+        case IND_INIT::Start:
+        {
+            if (show & _showInit)
+                routeLogByValue(LOG_TYPE::INFO, "%s(): IND_INIT::Start", __func__);
 
-                    if (cycles > 0)
-                        indInitStep = IND_INIT::ColorC_On;
-                    else
-                        indInitStep = IND_INIT::ColorC_Off;
+            indInitStep = IND_INIT::StartRMTDriver;
+            [[fallthrough]];
+        }
 
-                    vTaskDelay(pdMS_TO_TICKS(250)); // Off Time
-                }
-                break;
-            }
+        case IND_INIT::StartRMTDriver:
+        {
+            if (show & _showInit)
+                routeLogByValue(LOG_TYPE::INFO, "%s(): IND_INIT::StartRMTDriver - Step %d", __func__, (int)IND_INIT::StartRMTDriver);
 
-            case IND_INIT::ColorC_On:
-            {
-                if (show & _showInit)
-                    routeLogByValue(LOG_TYPE::INFO, std::string(__func__) + "(): IND_INIT::ColorC_On - Step " + std::to_string((int)IND_INIT::ColorC_On));
+            if (!rmtEstablished)
+                ESP_GOTO_ON_ERROR(establishRMTDriver(), ind_startRMTDriver_err, TAG, "establishRMTDriver() failed");
+            indInitStep = IND_INIT::Set_LED_Initial_States;
+            break;
 
-                cycles--;
-                setAndClearColors((uint8_t)COLORC_Bit, 0);
-                vTaskDelay(pdMS_TO_TICKS(100));
-                indInitStep = IND_INIT::ColorC_Off;
-                break;
-            }
+        ind_startRMTDriver_err:
+            errFunc = __func__;
+            errCode = ret;
+            indOP = IND_OP::Error;
+            break;
+        }
 
-            case IND_INIT::ColorC_Off:
-            {
-                if (show & _showInit)
-                    routeLogByValue(LOG_TYPE::INFO, std::string(__func__) + "(): IND_INIT::ColorC_Off - Step " + std::to_string((int)IND_INIT::ColorC_Off));
+        case IND_INIT::Set_LED_Initial_States:
+        {
+            if (show & _showInit)
+                routeLogByValue(LOG_TYPE::INFO, "%s(): IND_INIT::Set_LED_Initial_States - Step %d", __func__, (int)IND_INIT::Set_LED_Initial_States);
 
-                setAndClearColors(0, (uint8_t)COLORC_Bit);
-                vTaskDelay(pdMS_TO_TICKS(150));
+            if (aState == LED_STATE::ON) // Now that the RMT driver has been initialized, we just need to set Color channels according to their States.
+                setAndClearColors(COLORA_Bit, 0);
+            else
+                setAndClearColors(0, COLORA_Bit);
 
-                if (cycles > 0)
-                    indInitStep = IND_INIT::ColorC_On;
-                else
-                {
-                    indInitStep = IND_INIT::StopRMTDriver;
-                    vTaskDelay(pdMS_TO_TICKS(250)); // Off Time
-                }
-                break;
-            }
+            if (bState == LED_STATE::ON)
+                setAndClearColors(COLORB_Bit, 0);
+            else
+                setAndClearColors(0, COLORB_Bit);
 
-            case IND_INIT::StopRMTDriver:
-            {
-                if (show & _showInit)
-                    routeLogByValue(LOG_TYPE::INFO, std::string(__func__) + "(): IND_INIT::StopRMTDriver - Step " + std::to_string((int)IND_INIT::StopRMTDriver));
+            if (cState == LED_STATE::ON)
+                setAndClearColors(COLORC_Bit, 0);
+            else
+                setAndClearColors(0, COLORC_Bit);
 
-                if (rmtEstablished)
-                    ESP_GOTO_ON_ERROR(demolishRMTDriver(), ind_stopRMTDriver_err, TAG, "demolishRMTDriver() failed");
-                indInitStep = IND_INIT::Finished;
-                break;
+            indInitStep = IND_INIT::Early_Release;
+            break;
+        }
 
-            ind_stopRMTDriver_err:
-                errMsg = std::string(__func__) + "(): " + esp_err_to_name(ret);
-                indOP = IND_OP::Error;
-                break;
-            }
+        case IND_INIT::Early_Release:
+        {
+            if (show & _showInit)
+                routeLogByValue(LOG_TYPE::INFO, "%s(): IND_INIT::Early_Release - Step %d", __func__, (int)IND_INIT::Early_Release);
 
-            case IND_INIT::Finished:
-            {
-                if (show & _showInit)
-                    routeLogByValue(LOG_TYPE::INFO, std::string(__func__) + "(): IND_INIT::Finished");
+            // In the event that no one else is using the LED for any kind of indication during initialization, the object can release it's locking semaphore early.
+            releaseEntry();
 
-                indOP = IND_OP::Run;
-                xSemaphoreGive(semIndEntry); // Yield now if not done earlier inside Early_Release
-                break;
-            }
+            // If any colors are in the On state, or if ALL colors are in the Off state, then bypass the Flashing of the version numbers.
+            if ((aState == LED_STATE::ON) || (bState == LED_STATE::ON) || (cState == LED_STATE::ON))
+                indInitStep = IND_INIT::Finished;
+            else if ((aState == LED_STATE::OFF) && (bState == LED_STATE::OFF) && (cState == LED_STATE::OFF))
+                indInitStep = IND_INIT::Finished;
+            else
+            {
+                startVersionFlash(); // Played by the Run state one dwell step at a time.  Any command that arrives ends it.
+                indInitStep = IND_INIT::StopRMTDriver;
             }
             break;
         }
 
-        case IND_OP::Error:
+        case IND_INIT::StopRMTDriver:
         {
-            routeLogByValue(LOG_TYPE::ERROR, errMsg);
-            indOP = IND_OP::Idle;
+            if (show & _showInit)
+                routeLogByValue(LOG_TYPE::INFO, "%s(): IND_INIT::StopRMTDriver - Step %d", __func__, (int)IND_INIT::StopRMTDriver);
+
+            if (rmtEstablished && !isDriverHeld() && !IsIndicating) // The version flash lets the driver go when it is finished
+                ESP_GOTO_ON_ERROR(demolishRMTDriver(), ind_stopRMTDriver_err, TAG, "demolishRMTDriver() failed");
+            indInitStep = IND_INIT::Finished;
+            break;
+
+        ind_stopRMTDriver_err:
+            errFunc = __func__;
+            errCode = ret;
+            indOP = IND_OP::Error;
             break;
         }
 
-        case IND_OP::Idle:
+        case IND_INIT::Finished:
         {
-            if (show & _showRun)
-                routeLogByValue(LOG_TYPE::INFO, std::string(__func__) + "(): IND_OP::Idle");
-            vTaskDelay(pdMS_TO_TICKS(5000));
+            if (show & _showInit)
+                routeLogByValue(LOG_TYPE::INFO, "%s(): IND_INIT::Finished", __func__);
+
+            indOP = IND_OP::Run;
+            releaseEntry(); // Yield now if not done earlier inside Early_Release
             break;
         }
         }
-        taskYIELD();
+        break;
     }
+
+    case IND_OP::Error:
+    {
+        routeLogByValue(LOG_TYPE::ERROR, "%s(): %s", errFunc, esp_err_to_name(errCode));
+        indOP = IND_OP::Idle;
+        break;
+    }
+
+    case IND_OP::Idle:
+    {
+        if (show & _showRun)
+            routeLogByValue(LOG_TYPE::INFO, "%s(): IND_OP::Idle", __func__);
+#if !CONFIG_WS2812_SHARED_SCHEDULER
+        vTaskDelay(pdMS_TO_TICKS(5000)); // The shared task keeps serving other devices instead
+#endif
+        break;
+    }
+    }
+
+    holdPower(IsIndicating); // A sequence in progress keeps the chip out of light sleep
+    return true;
 }
 
 esp_err_t Indication::establishRMTDriver()
@@ -469,7 +533,7 @@ esp_err_t Indication::establishRMTDriver()
     // WARNING: Some processors many NOT support DMA in the configuration below.  If not, just apply a 0 in the correct place.
     //
     rmt_tx_channel_config_t tx_chan_config = {
-        (gpio_num_t)RMT_LED_STRIP_GPIO_NUM, // selects GPIO
+        (gpio_num_t)ledGpio,                // selects GPIO
         RMT_CLK_SRC_DEFAULT,                // selects source clock
         RMT_LED_STRIP_RESOLUTION_HZ,        //
         64,                                 // Increasing the block size can make the LED flicker less
@@ -478,14 +542,16 @@ esp_err_t Indication::establishRMTDriver()
         {0, 1, 1, 0},                       // invert_out, with_dma, io_loop_back, io_od_mode
     };
 
-    ESP_RETURN_ON_ERROR(rmt_new_tx_channel(&tx_chan_config, &led_chan), TAG, "rmt_new_tx_channel() failed");
-
     led_strip_encoder_config_t encoder_config = {
         RMT_LED_STRIP_RESOLUTION_HZ,
     };
 
-    ESP_RETURN_ON_ERROR(rmt_new_led_strip_encoder(&encoder_config, &led_encoder), TAG, "rmt_new_led_strip_encoder() failed");
-    ESP_RETURN_ON_ERROR(rmt_enable(led_chan), TAG, "rmt_enable() failed");
+    if (led_chan == NULL) // Kept from the last indication when CONFIG_WS2812_HOLD_RMT_DRIVER is set
+    {
+        ESP_RETURN_ON_ERROR(rmt_new_tx_channel(&tx_chan_config, &led_chan), TAG, "rmt_new_tx_channel() failed");
+        ESP_RETURN_ON_ERROR(rmt_new_led_strip_encoder(&encoder_config, &led_encoder), TAG, "rmt_new_led_strip_encoder() failed");
+    }
+    ESP_RETURN_ON_ERROR(rmt_enable(led_chan), TAG, "rmt_enable() failed"); // The channel holds its own power management lock from here
     rmtEstablished = true;
     taskYIELD();
     return ret;
@@ -494,13 +560,57 @@ esp_err_t Indication::establishRMTDriver()
 esp_err_t Indication::demolishRMTDriver()
 {
     esp_err_t ret = ESP_OK;
-    ESP_RETURN_ON_ERROR(rmt_disable(led_chan), TAG, "rmt_disable() failed");
+    ESP_RETURN_ON_ERROR(rmt_disable(led_chan), TAG, "rmt_disable() failed"); // Lets go of the channel's power management lock
+    rmtEstablished = false;
+#if !CONFIG_WS2812_HOLD_RMT_DRIVER
+    ESP_RETURN_ON_ERROR(releaseRMTDriver(), TAG, "releaseRMTDriver() failed");
+#endif
+    return ret;
+}
+
+esp_err_t Indication::releaseRMTDriver()
+{
+    esp_err_t ret = ESP_OK;
+    if (led_chan == NULL)
+        return ret;
     ESP_RETURN_ON_ERROR(rmt_del_encoder(led_encoder), TAG, "rmt_del_encoder() failed");
     ESP_RETURN_ON_ERROR(rmt_del_channel(led_chan), TAG, "rmt_del_channel() failed");
-    rmtEstablished = false;
+    led_encoder = NULL;
+    led_chan = NULL;
     return ret;
 }
 
+void Indication::startCommand(void)
+{
+    if (compositeShown) // Indications start from a dark LED, not from the layers
+    {
+        aCurrValue = 0;
+        bCurrValue = 0;
+        cCurrValue = 0;
+        compositeShown = false;
+    }
+
+    if (activeCmd.flags & CMD_Version)
+        runProgram(versionProgram, versionLength);
+    else if (activeCmd.flags & CMD_Program)
+        startProgram((uint8_t)activeCmd.value);
+    else if (activeCmd.flags & CMD_Pattern)
+        startPattern((uint8_t)activeCmd.value);
+    else
+        startIndication(activeCmd.value);
+
+    if (activeCmd.ticket == nullptr)
+        return;
+
+    signalTicket(activeCmd.ticket, IND_TICKET::Started);
+
+    if (!IsIndicating) // State changes are complete with their single frame
+    {
+        signalTicket(activeCmd.ticket, IND_TICKET::Finished);
+        activeCmd.ticket = nullptr;
+    }
+}
+
 void Indication::startIndication(uint32_t value)
 {
     esp_err_t ret = ESP_OK;
@@ -514,6 +624,9 @@ void Indication::startIndication(uint32_t value)
     on_time = (0x0000FF00 & value) >> 8; // Time out
     off_time = (0x000000FF & value);     // Dark Time
 
+    first_color_target = latchColorTarget(first_color_target, firstPalette, &firstUsesPalette); // Palette colors become their channel bits
+    second_color_target = latchColorTarget(second_color_target, secondPalette, &secondUsesPalette);
+
     first_on_time_counter = on_time;
     second_on_time_counter = on_time;
 
@@ -646,7 +759,10 @@ void Indication::startIndication(uint32_t value)
     }
     else
     {
-        setAndClearColors(first_color_target, 0); // Process normal color display
+        setAndClearColors(first_color_target, 0, firstUsesPalette ? firstPalette : nullptr); // Process normal color display
+#if CONFIG_WS2812_STRESS_HARNESS
+        stressNoteFrame(value); // First frame of this command is out
+#endif
         first_color_cycles--;
         indState = IND_STATES::Clear_FirstColor;
         IsIndicating = true;
@@ -654,18 +770,17 @@ void Indication::startIndication(uint32_t value)
     return;
 
 ind_startIndication_err:
-    errMsg = std::string(__func__) + "(): " + esp_err_to_name(ret);
+    errFunc = __func__;
+    errCode = ret;
     indOP = IND_OP::Error;
 }
 
-void Indication::setAndClearColors(uint8_t SetColors, uint8_t ClearColors)
+void Indication::setAndClearColors(uint8_t SetColors, uint8_t ClearColors, const uint8_t *levels)
 {
-    esp_err_t ret = ESP_OK;
-    uint8_t led_strip_pixels[3];
-
-    led_strip_pixels[0] = bCurrValue; // Green
-    led_strip_pixels[1] = aCurrValue; // Red
-    led_strip_pixels[2] = cCurrValue; // Blue
+    // levels, when given, is a palette color.  Its A, B and C levels are scaled by the set levels of the colors being set.
+#if CONFIG_WS2812_STRESS_HARNESS
+    benchNoteEdge(); // Compare this call with the edge it belongs to
+#endif
 
     if (ClearColors & COLORA_Bit) // Seeing the bit to Clear this color
     {
@@ -673,9 +788,7 @@ void Indication::setAndClearColors(uint8_t SetColors, uint8_t ClearColors)
             aCurrValue = aSetLevel; // Don't turn off this value because our state is ON
         else
             aCurrValue = 0; // Otherwise, turn it off.
-
-        led_strip_pixels[1] = aCurrValue; // Red
-        // ESP_LOGW(TAG, "Red    State = %s / Value = %d", getStateText(aState).c_str(), aCurrValue);
+        // ESP_LOGW(TAG, "Red    State = %s / Value = %d", getStateText(aState), aCurrValue);
     }
 
     if (ClearColors & COLORB_Bit)
@@ -685,8 +798,7 @@ void Indication::setAndClearColors(uint8_t SetColors, uint8_t ClearColors)
         else
             bCurrValue = 0;
 
-        led_strip_pixels[0] = bCurrValue; // Green
-        // ESP_LOGW(TAG, "Green  State = %s / Value = %d", getStateText(bState).c_str(), bCurrValue);
+        // ESP_LOGW(TAG, "Green  State = %s / Value = %d", getStateText(bState), bCurrValue);
     }
 
     if (ClearColors & COLORC_Bit)
@@ -696,8 +808,7 @@ void Indication::setAndClearColors(uint8_t SetColors, uint8_t ClearColors)
         else
             cCurrValue = 0;
 
-        led_strip_pixels[2] = cCurrValue; // Blue
-        // ESP_LOGW(TAG, "Blue   State = %s / Value = %d", getStateText(cState).c_str(), cCurrValue);
+        // ESP_LOGW(TAG, "Blue   State = %s / Value = %d", getStateText(cState), cCurrValue);
     }
 
     if (SetColors & COLORA_Bit) // Setting the bit to Set this color
@@ -705,10 +816,8 @@ void Indication::setAndClearColors(uint8_t SetColors, uint8_t ClearColors)
         if (aState == LED_STATE::OFF) // Set the color if the state is set above OFF
             aCurrValue = 0;           // Don't allow any value to be displayed on the LED
         else
-            aCurrValue = aSetLevel; // State is either AUTO or ON.
-
-        led_strip_pixels[1] = aCurrValue; // Red
-        // ESP_LOGW(TAG, "Red    State = %s / Value = %d", getStateText(aState).c_str(), aCurrValue);
+            aCurrValue = (levels != nullptr) ? scalePaletteLevel(levels[0], aSetLevel) : aSetLevel; // State is either AUTO or ON.
+        // ESP_LOGW(TAG, "Red    State = %s / Value = %d", getStateText(aState), aCurrValue);
     }
 
     if (SetColors & COLORB_Bit)
@@ -716,10 +825,9 @@ void Indication::setAndClearColors(uint8_t SetColors, uint8_t ClearColors)
         if (bState == LED_STATE::OFF)
             bCurrValue = 0;
         else
-            bCurrValue = bSetLevel;
+            bCurrValue = (levels != nullptr) ? scalePaletteLevel(levels[1], bSetLevel) : bSetLevel;
 
-        led_strip_pixels[0] = bCurrValue; // Green
-        // ESP_LOGW(TAG, "Green  State = %s / Value = %d", getStateText(bState).c_str(), bCurrValue);
+        // ESP_LOGW(TAG, "Green  State = %s / Value = %d", getStateText(bState), bCurrValue);
     }
 
     if (SetColors & COLORC_Bit)
@@ -727,18 +835,61 @@ void Indication::setAndClearColors(uint8_t SetColors, uint8_t ClearColors)
         if (cState == LED_STATE::OFF)
             cCurrValue = 0;
         else
-            cCurrValue = cSetLevel;
+            cCurrValue = (levels != nullptr) ? scalePaletteLevel(levels[2], cSetLevel) : cSetLevel;
 
-        led_strip_pixels[2] = cCurrValue; // Blue
-        // ESP_LOGW(TAG, "Blue   State = %s / Value = %d", getStateText(cState).c_str(), cCurrValue);
+        // ESP_LOGW(TAG, "Blue   State = %s / Value = %d", getStateText(cState), cCurrValue);
     }
 
-    ESP_GOTO_ON_ERROR(rmt_transmit(led_chan, led_encoder, led_strip_pixels, sizeof(led_strip_pixels), &tx_config), ind_setAndClearColors_err, TAG, "rmt_transmit() failed");
-    ESP_GOTO_ON_ERROR(rmt_tx_wait_all_done(led_chan, portMAX_DELAY), ind_setAndClearColors_err, TAG, "rmt_tx_wait_all_done() failed");
+    transmitFrame();
+}
+
+void Indication::transmitFrame(void)
+{
+    // Every frame leaves through here.  The current values are the frame.
+    esp_err_t ret = ESP_OK;
+    uint8_t led_strip_pixels[3];
+    bool brief = false;
+
+#if CONFIG_WS2812_GAMMA
+    ditherPending = false; // outputLevel() raises this again for any channel with a fraction
+#if CONFIG_WS2812_DITHER
+    stepHadFrame = true;
+#endif
+
+    led_strip_pixels[0] = outputLevel(1, bCurrValue); // Green
+    led_strip_pixels[1] = outputLevel(0, aCurrValue); // Red
+    led_strip_pixels[2] = outputLevel(2, cCurrValue); // Blue
+#else
+    led_strip_pixels[0] = bCurrValue; // Green
+    led_strip_pixels[1] = aCurrValue; // Red
+    led_strip_pixels[2] = cCurrValue; // Blue
+#endif
+
+#if CONFIG_WS2812_POWER_LIMIT
+    if (limitFramePower(led_strip_pixels, 1, CONFIG_WS2812_POWER_BUDGET_MA) > CONFIG_WS2812_POWER_BUDGET_MA)
+    {
+        taskENTER_CRITICAL(&pmStatsLock);
+        pmStats.limited++;
+        taskEXIT_CRITICAL(&pmStatsLock);
+    }
+#endif
+
+    brief = !powerHeld; // A frame outside a sequence holds the power lock just while it is on the wire
+    if (brief)
+        holdPower(true);
+
+    ESP_GOTO_ON_ERROR(rmt_transmit(led_chan, led_encoder, led_strip_pixels, sizeof(led_strip_pixels), &tx_config), ind_transmitFrame_err, TAG, "rmt_transmit() failed");
+    ESP_GOTO_ON_ERROR(rmt_tx_wait_all_done(led_chan, portMAX_DELAY), ind_transmitFrame_err, TAG, "rmt_tx_wait_all_done() failed");
+
+    if (brief)
+        holdPower(false);
     return;
 
-ind_setAndClearColors_err:
-    errMsg = std::string(__func__) + "(): " + esp_err_to_name(ret);
+ind_transmitFrame_err:
+    if (brief)
+        holdPower(false);
+    errFunc = __func__;
+    errCode = ret;
     indOP = IND_OP::Error;
 }
 
@@ -758,4 +909,8 @@ void Indication::resetIndication()
 
     indState = IND_STATES::Idle;
     IsIndicating = false;
+    progActive = false;
+    firstUsesPalette = false;
+    secondUsesPalette = false;
+    fade = {};
 }
\ No newline at end of file
@@ -0,0 +1,169 @@
+#include "indication/indication_.hpp"
+
+//
+// submitIndicationAt() holds a command back until an absolute esp_timer time (microseconds, as from esp_timer_get_time()).
+// Producers hand scheduled commands to the run task through a small queue.  The run task owns a min-heap ordered by release
+// time.  Due commands move into their class queue, so priority and preemption work exactly as they do for submitIndication().
+//
+// While idle, the run task sleeps on the command queue only until the earliest release time.  A time already in the past
+// releases the command right away.  Release is checked on every pass of the run loop, so an indication that is running is
+// only interrupted by a scheduled command of a higher class.
+//
+
+/* Scheduled Commands */
+esp_err_t Indication::submitIndicationAt(uint32_t value, int64_t atUs, TickType_t ticksToWait, IND_PRIORITY priority, ind_ticket_t *ticket)
+{
+    ind_sched_t entry = {atUs, 0, {value, priority, 0, ticket}};
+
+    ESP_RETURN_ON_FALSE((uint8_t)priority < IND_PRIORITY_CLASSES, ESP_ERR_INVALID_ARG, TAG, "unknown priority class");
+    ESP_RETURN_ON_FALSE(value != IND_CMD_WAKE, ESP_ERR_INVALID_ARG, TAG, "command value is reserved");
+    ESP_RETURN_ON_FALSE(queHandleIndSchedule != nullptr, ESP_ERR_INVALID_STATE, TAG, "schedule queue does not exist");
+
+    if (ticket != nullptr)
+    {
+        ticket->state = IND_TICKET::Queued;
+        ticket->enqueueUs = esp_timer_get_time();
+        ticket->startUs = 0;
+        ticket->finishUs = 0;
+    }
+
+    if (xQueueSendToBack(queHandleIndSchedule, &entry, ticksToWait) != pdTRUE)
+    {
+        taskENTER_CRITICAL(&queLock);
+        queStats.schedDropped++;
+        taskEXIT_CRITICAL(&queLock);
+
+        if (ticket != nullptr)
+            signalTicket(ticket, IND_TICKET::Dropped);
+        return ESP_ERR_TIMEOUT;
+    }
+
+    taskENTER_CRITICAL(&queLock);
+    queStats.scheduled++;
+    taskEXIT_CRITICAL(&queLock);
+
+    wakeRunTask(); // The run task may need to sleep for a shorter time
+    return ESP_OK;
+}
+
+/* Schedule Heap */
+static bool schedBefore(const ind_sched_t *a, const ind_sched_t *b)
+{
+    if (a->atUs != b->atUs)
+        return a->atUs < b->atUs;
+    return (int32_t)(a->order - b->order) < 0;
+}
+
+void Indication::collectScheduled(void)
+{
+    ind_sched_t entry = {};
+    ind_sched_t swap = {};
+    uint8_t child = 0;
+
+    while (xQueueReceive(queHandleIndSchedule, &entry, 0) == pdTRUE)
+    {
+        if (schedCount >= CONFIG_WS2812_SCHEDULE_DEPTH)
+        {
+            taskENTER_CRITICAL(&queLock);
+            queStats.schedDropped++;
+            taskEXIT_CRITICAL(&queLock);
+
+            if (entry.cmd.ticket != nullptr)
+                signalTicket(entry.cmd.ticket, IND_TICKET::Dropped);
+            continue;
+        }
+
+        entry.order = schedOrder++;
+        child = schedCount++;
+        schedHeap[child] = entry;
+
+        while (child > 0) // Sift up
+        {
+            uint8_t parent = (child - 1) / 2;
+
+            if (!schedBefore(&schedHeap[child], &schedHeap[parent]))
+                break;
+
+            swap = schedHeap[parent];
+            schedHeap[parent] = schedHeap[child];
+            schedHeap[child] = swap;
+            child = parent;
+        }
+    }
+}
+
+void Indication::releaseDueCmds(void)
+{
+    int64_t now = 0;
+    ind_sched_t swap = {};
+    uint8_t parent = 0;
+
+    collectScheduled();
+
+    if (schedCount == 0)
+        return;
+
+    now = esp_timer_get_time();
+
+    while ((schedCount > 0) && (schedHeap[0].atUs <= now))
+    {
+        if (xQueueSendToBack(queHandleIndPriority[(uint8_t)schedHeap[0].cmd.priority], &schedHeap[0].cmd, 0) != pdTRUE)
+        {
+            taskENTER_CRITICAL(&queLock);
+            queStats.schedDropped++;
+            taskEXIT_CRITICAL(&queLock);
+
+            if (schedHeap[0].cmd.ticket != nullptr)
+                signalTicket(schedHeap[0].cmd.ticket, IND_TICKET::Dropped);
+        }
+
+        schedHeap[0] = schedHeap[--schedCount];
+        parent = 0;
+
+        while (true) // Sift down
+        {
+            uint8_t left = (2 * parent) + 1;
+            uint8_t right = left + 1;
+            uint8_t first = parent;
+
+            if ((left < schedCount) && schedBefore(&schedHeap[left], &schedHeap[first]))
+                first = left;
+            if ((right < schedCount) && schedBefore(&schedHeap[right], &schedHeap[first]))
+                first = right;
+            if (first == parent)
+                break;
+
+            swap = schedHeap[parent];
+            schedHeap[parent] = schedHeap[first];
+            schedHeap[first] = swap;
+            parent = first;
+        }
+    }
+}
+
+TickType_t Indication::ticksUntilNextRelease(TickType_t limit)
+{
+    int64_t remaining = 0;
+    int64_t ticks = 0;
+
+    if (schedCount == 0)
+        return limit;
+
+    remaining = schedHeap[0].atUs - esp_timer_get_time();
+    if (remaining <= 0)
+        return 0;
+
+    ticks = ((remaining * configTICK_RATE_HZ) + 999999) / 1000000; // Round up so we never wake before the release time
+    return (ticks < (int64_t)limit) ? (TickType_t)ticks : limit;
+}
+
+void Indication::dropScheduledCmds(void)
+{
+    collectScheduled();
+
+    while (schedCount > 0)
+    {
+        if (schedHeap[--schedCount].cmd.ticket != nullptr)
+            signalTicket(schedHeap[schedCount].cmd.ticket, IND_TICKET::Dropped);
+    }
+}
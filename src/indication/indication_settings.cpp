@@ -0,0 +1,103 @@
+#include "indication/indication_.hpp"
+
+//
+// setChannelSettings() changes any mix of channel levels and states as one transaction.  Publishers merge their changes into
+// a single pending block, so updates from several tasks never overwrite each other, and the run task picks up the whole block
+// at once.  One notification bit (NFY_APPLY_SETTINGS) tells the run task to look, no matter how many publishers came before.
+//
+
+/* Channel Settings */
+esp_err_t Indication::setChannelSettings(const ind_settings_t *settings)
+{
+    ESP_RETURN_ON_FALSE(settings, ESP_ERR_INVALID_ARG, TAG, "settings can not be null...");
+    ESP_RETURN_ON_FALSE(taskHandleRun != nullptr, ESP_ERR_INVALID_STATE, TAG, "run task does not exist");
+
+    taskENTER_CRITICAL(&settingsLock);
+
+    if (settings->levelMask & COLORA_Bit)
+        settingsPending.aLevel = settings->aLevel;
+    if (settings->levelMask & COLORB_Bit)
+        settingsPending.bLevel = settings->bLevel;
+    if (settings->levelMask & COLORC_Bit)
+        settingsPending.cLevel = settings->cLevel;
+
+    settingsPending.levelMask |= (settings->levelMask & (COLORA_Bit | COLORB_Bit | COLORC_Bit));
+
+    if (settings->aState != LED_STATE::NONE)
+        settingsPending.aState = settings->aState;
+    if (settings->bState != LED_STATE::NONE)
+        settingsPending.bState = settings->bState;
+    if (settings->cState != LED_STATE::NONE)
+        settingsPending.cState = settings->cState;
+
+    taskEXIT_CRITICAL(&settingsLock);
+
+    postNotify(static_cast<uint32_t>(IND_NOTIFY::NFY_APPLY_SETTINGS)); // Bits merge with any pending value, so this never fails
+    wakeRunTask();
+    return ESP_OK;
+}
+
+void Indication::applyChannelSettings(void)
+{
+    esp_err_t ret = ESP_OK;
+    ind_settings_t settings = {};
+    uint8_t setColors = 0;
+    uint8_t clearColors = 0;
+
+    taskENTER_CRITICAL(&settingsLock);
+    settings = settingsPending;
+    settingsPending = {}; // Everything pending is now ours
+    taskEXIT_CRITICAL(&settingsLock);
+
+    if ((settings.levelMask == 0) && (settings.aState == LED_STATE::NONE) && (settings.bState == LED_STATE::NONE) && (settings.cState == LED_STATE::NONE))
+        return;
+
+    if (settings.levelMask & COLORA_Bit)
+        aSetLevel = settings.aLevel;
+    if (settings.levelMask & COLORB_Bit)
+        bSetLevel = settings.bLevel;
+    if (settings.levelMask & COLORC_Bit)
+        cSetLevel = settings.cLevel;
+
+    if (settings.aState != LED_STATE::NONE)
+        aState = settings.aState;
+    if (settings.bState != LED_STATE::NONE)
+        bState = settings.bState;
+    if (settings.cState != LED_STATE::NONE)
+        cState = settings.cState;
+
+    startNVSDelayTicks = xTaskGetTickCount();
+
+    // Channels held ON show their new level right away and channels switched ON or OFF change now.  AUTO channels wait for the next indication.
+    if ((aState == LED_STATE::ON) && ((settings.levelMask & COLORA_Bit) || (settings.aState == LED_STATE::ON)))
+        setColors |= COLORA_Bit;
+    if ((bState == LED_STATE::ON) && ((settings.levelMask & COLORB_Bit) || (settings.bState == LED_STATE::ON)))
+        setColors |= COLORB_Bit;
+    if ((cState == LED_STATE::ON) && ((settings.levelMask & COLORC_Bit) || (settings.cState == LED_STATE::ON)))
+        setColors |= COLORC_Bit;
+
+    if (settings.aState == LED_STATE::OFF)
+        clearColors |= COLORA_Bit;
+    if (settings.bState == LED_STATE::OFF)
+        clearColors |= COLORB_Bit;
+    if (settings.cState == LED_STATE::OFF)
+        clearColors |= COLORC_Bit;
+
+    if ((setColors | clearColors) == 0)
+        return;
+
+    if (!rmtEstablished)
+        ESP_GOTO_ON_ERROR(establishRMTDriver(), ind_applyChannelSettings_err, TAG, "establishRMTDriver() failed");
+
+    setAndClearColors(setColors, clearColors);
+    compositeShown = false; // Layers are put back through the new states
+
+    if (!IsIndicating && !isDriverHeld()) // Nobody else needs the driver
+        ESP_GOTO_ON_ERROR(demolishRMTDriver(), ind_applyChannelSettings_err, TAG, "demolishRMTDriver() failed");
+    return;
+
+ind_applyChannelSettings_err:
+    errFunc = __func__;
+    errCode = ret;
+    indOP = IND_OP::Error;
+}
@@ -0,0 +1,270 @@
+#include "indication/indication_.hpp"
+
+#if CONFIG_WS2812_SHARED_SCHEDULER
+
+#include <algorithm> // Native Libraries
+
+//
+// With CONFIG_WS2812_SHARED_SCHEDULER, objects do not create their own run task.  Each one registers here and a single
+// scheduler task calls runPass() for every device in turn, so boards with several indicators pay for one stack instead of one
+// per device.  Each object still owns its own queues, RMT channel (on its own GPIO) and state.
+//
+// While any device is indicating, the task waits one shared dwell step between passes -- one esp_timer (or the RTOS tick) for
+// all devices.  Otherwise it sleeps on its task notification until the earliest idle deadline of any device.  Submitters ring
+// that notification as a doorbell, and notification bits meant for a device are kept in that device (see postNotify()).
+//
+// The first device to register creates the task with its runStackSizeK.  The task deletes itself when the last device leaves,
+// unless it was created statically -- then it waits for the next device to register.
+//
+// Only the shared task touches the dwell timer.  It creates the timer the first time it needs a step and deletes it when the
+// last device leaves, before it lets a new task be started, so two tasks never share one timer.
+//
+
+#if CONFIG_WS2812_TIMING_ESP_TIMER
+/* Local Semaphores */
+static SemaphoreHandle_t semSharedDwell = nullptr; // Given by the shared timer once per step
+
+#if CONFIG_WS2812_STATIC_ALLOCATION
+static StaticSemaphore_t semSharedDwellBuffer;
+#endif
+
+static esp_timer_handle_t sharedDwellTimer = nullptr;
+static bool sharedDwellRunning = false;
+
+static void sharedDwellCallback(void *arg)
+{
+    xSemaphoreGive((SemaphoreHandle_t)arg); // Runs in the esp_timer task
+}
+
+static esp_err_t sharedDwellCreate(void)
+{
+    esp_timer_create_args_t args = {};
+
+    if (semSharedDwell == nullptr) // Kept once created.  It is only a counter.
+        semSharedDwell = IND_SEMAPHORE_CREATE_BINARY(&semSharedDwellBuffer);
+    if (semSharedDwell == nullptr)
+        return ESP_ERR_NO_MEM;
+
+    args.callback = &sharedDwellCallback;
+    args.arg = semSharedDwell;
+    args.dispatch_method = ESP_TIMER_TASK;
+    args.name = "ind_dwell";
+    args.skip_unhandled_events = true;
+    return esp_timer_create(&args, &sharedDwellTimer);
+}
+
+static void sharedDwellDelete(void)
+{
+    if (sharedDwellTimer == nullptr)
+        return;
+
+    if (sharedDwellRunning)
+        esp_timer_stop(sharedDwellTimer);
+    esp_timer_delete(sharedDwellTimer);
+    sharedDwellTimer = nullptr;
+    sharedDwellRunning = false;
+}
+#endif
+
+#if CONFIG_WS2812_STATIC_ALLOCATION
+static StaticTask_t sharedTaskBuffer; // Created once.  The task waits for devices rather than ending.
+static StackType_t sharedTaskStack[IND_STACK_WORDS];
+#endif
+
+Indication *Indication::sharedDevices[CONFIG_WS2812_SHARED_DEVICES] = {};
+TaskHandle_t Indication::sharedTask = nullptr;
+portMUX_TYPE Indication::sharedLock = portMUX_INITIALIZER_UNLOCKED;
+int64_t Indication::sharedEdgeUs = 0;
+int64_t Indication::sharedDueUs = 0;
+
+/* Shared Scheduler */
+esp_err_t Indication::joinSharedScheduler(void)
+{
+    esp_err_t ret = ESP_ERR_NO_MEM;
+    uint8_t slot = 0;
+    bool start = false;
+
+    resetIndication(); // What our own run() would have done first
+
+    taskENTER_CRITICAL(&sharedLock);
+    for (slot = 0; slot < CONFIG_WS2812_SHARED_DEVICES; slot++)
+    {
+        if (sharedDevices[slot] == nullptr)
+        {
+            sharedDevices[slot] = this;
+            start = (sharedTask == nullptr);
+            ret = ESP_OK;
+            break;
+        }
+    }
+    taskEXIT_CRITICAL(&sharedLock);
+
+    ESP_GOTO_ON_ERROR(ret, ind_joinSharedScheduler_err, TAG, "no free shared scheduler slot");
+
+    if (start)
+    {
+        routeLogByValue(LOG_TYPE::INFO, "%s(): runStackSizek: %d", __func__, runStackSizeK);
+
+#if CONFIG_WS2812_STATIC_ALLOCATION
+        sharedTask = xTaskCreateStatic(sharedScheduler, "ind_shared", IND_STACK_WORDS, nullptr, TASK_PRIORITY_LOW, sharedTaskStack, &sharedTaskBuffer);
+        ESP_GOTO_ON_FALSE(sharedTask, ESP_ERR_INVALID_STATE, ind_joinSharedScheduler_leave, TAG, "xTaskCreateStatic() failed");
+#else
+        if (xTaskCreate(sharedScheduler, "ind_shared", 1024 * runStackSizeK, nullptr, TASK_PRIORITY_LOW, &sharedTask) != pdPASS)
+        {
+            sharedTask = nullptr;
+            ret = ESP_ERR_NO_MEM;
+            goto ind_joinSharedScheduler_leave;
+        }
+#endif
+    }
+
+    taskHandleRun = sharedTask;
+    wakeRunTask(); // Our first pass starts the Init steps
+    return ESP_OK;
+
+ind_joinSharedScheduler_leave:
+    taskENTER_CRITICAL(&sharedLock);
+    sharedDevices[slot] = nullptr;
+    taskEXIT_CRITICAL(&sharedLock);
+
+ind_joinSharedScheduler_err:
+    routeLogByValue(LOG_TYPE::ERROR, "%s(): error: %s", __func__, esp_err_to_name(ret));
+    return ret;
+}
+
+void Indication::sharedScheduler(void *arg)
+{
+    Indication *dev = nullptr;
+    TickType_t wait = 0;
+    uint8_t remaining = 0;
+    bool busy = false;
+
+    while (true)
+    {
+        busy = false;
+        wait = pdMS_TO_TICKS(245);
+
+        for (uint8_t i = 0; i < CONFIG_WS2812_SHARED_DEVICES; i++)
+        {
+            taskENTER_CRITICAL(&sharedLock);
+            dev = sharedDevices[i];
+            taskEXIT_CRITICAL(&sharedLock);
+
+            if (dev == nullptr)
+                continue;
+
+            if (!dev->runPass()) // This device has finished its shutdown
+            {
+                taskENTER_CRITICAL(&sharedLock);
+                sharedDevices[i] = nullptr;
+                taskEXIT_CRITICAL(&sharedLock);
+
+                dev->taskHandleRun = nullptr;
+                xSemaphoreGive(dev->semIndJoin); // Its destructor is joined on this.  The object may be gone right after.
+                continue;
+            }
+
+            dev->publishSnapshot();
+
+            if (dev->IsIndicating || ((dev->indOP != IND_OP::Run) && (dev->indOP != IND_OP::Idle))) // Init, Shutdown and Error steps want the next pass soon
+                busy = true;
+            else
+                wait = std::min(wait, dev->idleWaitTicks());
+        }
+
+        taskENTER_CRITICAL(&sharedLock);
+        remaining = sharedDeviceCount();
+        taskEXIT_CRITICAL(&sharedLock);
+
+        if (remaining == 0)
+        {
+#if CONFIG_WS2812_TIMING_ESP_TIMER
+            sharedDwellDelete(); // Gone before a new task could be started to use it
+#endif
+#if CONFIG_WS2812_STATIC_ALLOCATION
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY); // Our stack is static memory, so we wait for the next device instead of deleting ourselves
+            continue;
+#else
+            taskENTER_CRITICAL(&sharedLock);
+            remaining = sharedDeviceCount();
+            if (remaining == 0)
+                sharedTask = nullptr; // A device that registers after this starts a new task
+            taskEXIT_CRITICAL(&sharedLock);
+
+            if (remaining == 0)
+                break;
+            continue; // A device registered while the timer was deleted.  Its first step creates a new one.
+#endif
+        }
+
+        if (busy)
+            sharedDwellWait();
+        else
+        {
+            sharedDwellStop();
+            ulTaskNotifyTake(pdTRUE, wait); // A submitter's doorbell ends this early
+        }
+    }
+
+    vTaskDelete(NULL); // The timer is already deleted
+}
+
+uint8_t Indication::sharedDeviceCount(void)
+{
+    uint8_t count = 0; // Call with sharedLock held
+
+    for (uint8_t i = 0; i < CONFIG_WS2812_SHARED_DEVICES; i++)
+    {
+        if (sharedDevices[i] != nullptr)
+            count++;
+    }
+    return count;
+}
+
+void Indication::sharedDwellWait(void)
+{
+    int64_t now = 0;
+
+#if CONFIG_WS2812_TIMING_ESP_TIMER
+    if (!sharedDwellRunning)
+    {
+        if ((sharedDwellTimer != nullptr) || (sharedDwellCreate() == ESP_OK)) // Created on the first step after the last device left
+        {
+            xSemaphoreTake(semSharedDwell, 0); // Forget a give left over from the last busy period
+            if (esp_timer_start_periodic(sharedDwellTimer, IND_DWELL_US) == ESP_OK)
+                sharedDwellRunning = true;
+        }
+        sharedDueUs = esp_timer_get_time() + IND_DWELL_US;
+    }
+
+    if (sharedDwellRunning)
+        xSemaphoreTake(semSharedDwell, pdMS_TO_TICKS(4 * IND_DWELL_US / 1000) + 1); // The timeout only guards against a stopped timer
+    else
+        vTaskDelay(pdMS_TO_TICKS(IND_DWELL_US / 1000) + 1); // Could not start the timer -- fall back to the tick
+#else
+    TickType_t startDwellTime = xTaskGetTickCount();
+
+    sharedDueUs = esp_timer_get_time() + IND_DWELL_US;
+    xTaskDelayUntil(&startDwellTime, pdMS_TO_TICKS(IND_DWELL_US / 1000));
+#endif
+
+    now = esp_timer_get_time();
+    sharedEdgeUs = sharedDueUs;
+    sharedDueUs += IND_DWELL_US;
+
+    while (sharedDueUs <= now) // Steps we slept through are not owed
+        sharedDueUs += IND_DWELL_US;
+}
+
+void Indication::sharedDwellStop(void)
+{
+#if CONFIG_WS2812_TIMING_ESP_TIMER
+    if (sharedDwellRunning)
+    {
+        esp_timer_stop(sharedDwellTimer);
+        sharedDwellRunning = false;
+    }
+#endif
+}
+
+#endif
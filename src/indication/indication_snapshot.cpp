@@ -0,0 +1,52 @@
+#include "indication/indication_.hpp"
+
+//
+// The run task publishes a copy of its state once per pass through its loop.  Readers never take a lock and never make the run
+// task wait.  The copy is guarded by a sequence counter (a seqlock): the counter is odd while the run task writes, and a reader
+// simply copies again if the counter was odd or changed underneath it.  With a single writer and a copy this small, a reader
+// repeats only when it collides with the few instructions of a write.
+//
+
+/* State Snapshot */
+void Indication::getSnapshot(ind_snapshot_t *snap)
+{
+    uint32_t before = 0;
+    uint32_t after = 0;
+
+    if (snap == nullptr)
+        return;
+
+    do
+    {
+        before = snapSeq.load(std::memory_order_acquire);
+        *snap = snapshot;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        after = snapSeq.load(std::memory_order_relaxed);
+    } while ((before & 1) || (before != after));
+}
+
+void Indication::publishSnapshot(void)
+{
+    uint32_t seq = snapSeq.load(std::memory_order_relaxed);
+
+    snapSeq.store(seq + 1, std::memory_order_relaxed); // Odd -- a write is in progress
+    std::atomic_thread_fence(std::memory_order_release);
+
+    snapshot.sequence = (seq + 2) / 2;
+    snapshot.indOP = indOP;
+    snapshot.indState = indState;
+    snapshot.isIndicating = IsIndicating;
+    snapshot.activeCmd = activeCmd;
+    snapshot.persistValue = persistValue;
+    snapshot.aState = aState;
+    snapshot.bState = bState;
+    snapshot.cState = cState;
+    snapshot.aSetLevel = aSetLevel;
+    snapshot.bSetLevel = bSetLevel;
+    snapshot.cSetLevel = cSetLevel;
+    snapshot.aCurrValue = aCurrValue;
+    snapshot.bCurrValue = bCurrValue;
+    snapshot.cCurrValue = cCurrValue;
+
+    snapSeq.store(seq + 2, std::memory_order_release); // Even -- the copy is complete
+}
@@ -0,0 +1,734 @@
+#include "indication/indication_.hpp"
+
+#if CONFIG_WS2812_STRESS_HARNESS
+
+#include <algorithm> // Native Libraries
+#include <cstring>
+
+#include "esp_heap_caps.h" // ESP Libraries
+#include "esp_random.h"
+#include "esp_timer.h"
+
+//
+// The stress harness is a development tool.  It floods our command queue from several producer tasks and measures
+// what those producers experience.  Each producer owns a small FIFO of enqueue time stamps.  Because the command queue
+// is also a FIFO, the N-th command the run task receives from a producer always matches the N-th stamp of that producer.
+//
+// Stress commands carry the producer id in the second color cycles nibble with no second color set.  That nibble is
+// otherwise ignored by the run loop, so the command still displays normally.  Do not send other commands during a test.
+//
+// The class isolation test keeps the Routine queue full with a Block submitter while the caller submits Alarm commands,
+// and reports how long those Alarm submits take.  Submit locks are per class, so they should never wait on Routine.
+//
+// The jitter benchmark plays a fast persistent pattern while optional load runs: busy tasks at a chosen priority and core,
+// and a periodic esp_timer callback that spins (the esp_timer task runs above nearly everything, much like an interrupt).
+// Each setAndClearColors() made on a dwell step is compared with the time that step was meant to end.  First frames that
+// start from idle have no intended time and are only counted.
+//
+// The effects benchmark runs each effect kernel over buffers of 1, 64 and 1024 pixels in the calling task and reports pixels
+// per second.  Every size processes about the same number of pixels, so the 1 pixel row shows the cost of a call.
+//
+// The heap check sends a burst of commands and log lines and compares free heap and its low water mark before and after.
+// One command and one log line go out first so allocations IDF makes on first use are not counted.  With static allocation
+// and the held RMT driver, the free heap should be the same afterwards and the low water mark should not move.
+//
+#define IND_STRESS_MAX_PRODUCERS 16
+#define IND_STRESS_STAMPS 64       // Must be a power of 2 and larger than the queue depth
+#define IND_STRESS_SAMPLES 128     // Enqueue latency samples kept per producer
+#define IND_STRESS_E2E_SAMPLES 512 // Command-to-frame samples kept for the run task
+
+static_assert((IND_STRESS_STAMPS & (IND_STRESS_STAMPS - 1)) == 0, "IND_STRESS_STAMPS must be a power of 2");
+static_assert(IND_STRESS_STAMPS > CONFIG_WS2812_CMD_QUEUE_DEPTH, "IND_STRESS_STAMPS must be larger than the command queue depth");
+
+typedef struct
+{
+    QueueHandle_t queue;
+    TaskHandle_t parent;
+    uint8_t id;
+    TickType_t period;
+    TickType_t sendTimeout;
+    volatile bool stop;
+
+    int64_t stamps[IND_STRESS_STAMPS]; // Enqueue time stamps (Producer writes tail, run task reads head)
+    volatile uint32_t stampHead;
+    volatile uint32_t stampTail;
+
+    uint32_t sent;
+    uint32_t dropped;
+    uint32_t blocked;      // Number of sends which found the queue full
+    uint64_t blockedUs;    // Time spent inside those sends
+    uint32_t enqueueSeen;  // Total enqueue latency samples offered (for reservoir sampling)
+    uint32_t enqueueCount; // Samples held
+    uint32_t enqueueUs[IND_STRESS_SAMPLES];
+} ind_stress_producer_t;
+
+struct ind_stress_t
+{
+    uint8_t producers;
+    uint32_t periodMs;
+    uint32_t durationMs;
+    uint32_t sendTimeoutMs;
+
+    uint32_t e2eSeen;
+    uint32_t e2eCount;
+    uint32_t e2eUs[IND_STRESS_E2E_SAMPLES];
+    uint32_t orphans; // Frames we could not pair with a stamp
+
+    ind_stress_producer_t producer[IND_STRESS_MAX_PRODUCERS];
+};
+
+#define IND_ISOLATION_SAMPLES 256        // Alarm submit latency samples kept
+#define IND_ISOLATION_ROUTINE 0x21000A40 // Green 1 flash with a long on time keeps the Routine queue full
+#define IND_ISOLATION_ALARM 0x11000101   // Red 1 flash, shortest on and off times
+
+typedef struct
+{
+    Indication *ind;
+    TaskHandle_t parent;
+    volatile bool stop;
+    uint32_t sent;
+    uint32_t timedOut;
+} ind_isolation_filler_t;
+
+#define IND_BENCH_SAMPLES 1024 // Edge lateness samples kept for the jitter benchmark
+#define IND_BENCH_MAX_LOAD 8
+#define IND_BENCH_PATTERN 0x71000101 // White, 1 flash, shortest on and off times
+
+typedef struct
+{
+    volatile bool stop;
+    TaskHandle_t parent;
+    uint8_t dutyPct;
+} ind_bench_task_t;
+
+struct ind_bench_t
+{
+    uint32_t lateSeen;
+    uint32_t lateCount;
+    uint32_t lateUs[IND_BENCH_SAMPLES];
+    uint32_t early;     // Edges that came before their intended time
+    uint32_t earlyMaxUs;
+    uint32_t untimed;   // Calls made outside a dwell step
+
+    ind_bench_task_t task[IND_BENCH_MAX_LOAD];
+    uint32_t timerBusyUs;
+};
+
+#define IND_EFFECTS_MAX_PIXELS 1024
+
+static const uint16_t effectsBenchSizes[] = {1, 64, IND_EFFECTS_MAX_PIXELS};
+
+#define IND_HEAP_CHECK_CMD 0x21000101   // Green 1 flash, shortest on and off times
+#define IND_HEAP_CHECK_DRAIN_MS 5000    // Longest wait for the run task to go idle after the burst
+
+static void stressSample(uint32_t *samples, uint32_t capacity, uint32_t *count, uint32_t *seen, uint32_t value)
+{
+    // Reservoir sampling keeps a fair picture of the whole run instead of only its beginning.
+    (*seen)++;
+
+    if (*count < capacity)
+        samples[(*count)++] = value;
+    else
+    {
+        uint32_t slot = esp_random() % *seen;
+        if (slot < capacity)
+            samples[slot] = value;
+    }
+}
+
+static uint32_t stressPercentile(const uint32_t *sorted, uint32_t count, uint8_t pct)
+{
+    if (count < 1)
+        return 0;
+    return sorted[((count - 1) * pct) / 100];
+}
+
+/* Stress Harness */
+esp_err_t Indication::runCmdQueueStressTest(uint8_t producers, uint32_t periodMs, uint32_t durationMs, uint32_t sendTimeoutMs)
+{
+    ind_stress_t *test = nullptr;
+    uint8_t started = 0;
+    uint8_t finished = 0;
+    TickType_t drainStart = 0;
+
+    ESP_RETURN_ON_FALSE((producers > 0) && (producers <= IND_STRESS_MAX_PRODUCERS), ESP_ERR_INVALID_ARG, TAG, "producers must be 1 to 16");
+    ESP_RETURN_ON_FALSE(periodMs > 0, ESP_ERR_INVALID_ARG, TAG, "periodMs can not be zero");
+    ESP_RETURN_ON_FALSE(queHandleIndCmdRequest != nullptr, ESP_ERR_INVALID_STATE, TAG, "command queue does not exist");
+    ESP_RETURN_ON_FALSE(stress == nullptr, ESP_ERR_INVALID_STATE, TAG, "a stress test is already running");
+
+    test = (ind_stress_t *)calloc(1, sizeof(ind_stress_t));
+    ESP_RETURN_ON_FALSE(test, ESP_ERR_NO_MEM, TAG, "Memory for ind_stress_t allocation failed...");
+
+    test->producers = producers;
+    test->periodMs = periodMs;
+    test->durationMs = durationMs;
+    test->sendTimeoutMs = sendTimeoutMs;
+
+    taskENTER_CRITICAL(&stressLock);
+    stress = test; // The run task now pairs frames with our stamps
+    taskEXIT_CRITICAL(&stressLock);
+
+    ulTaskNotifyTake(pdTRUE, 0); // Start with a clean count of finished producers
+
+    for (uint8_t i = 0; i < producers; i++)
+    {
+        ind_stress_producer_t *p = &test->producer[i];
+
+        p->queue = queHandleIndCmdRequest;
+        p->parent = xTaskGetCurrentTaskHandle();
+        p->id = i;
+        p->period = std::max<TickType_t>(pdMS_TO_TICKS(periodMs), 1);
+        p->sendTimeout = pdMS_TO_TICKS(sendTimeoutMs);
+
+        if (xTaskCreate(stressProducer, "ind_stress", 3072, p, TASK_PRIORITY_LOW, NULL) == pdPASS)
+            started++;
+        else
+            routeLogByValue(LOG_TYPE::ERROR, "%s(): Unable to create producer %d", __func__, i);
+    }
+
+    vTaskDelay(pdMS_TO_TICKS(durationMs));
+
+    for (uint8_t i = 0; i < producers; i++)
+        test->producer[i].stop = true;
+
+    while ((finished < started) && (ulTaskNotifyTake(pdFALSE, pdMS_TO_TICKS(1000)) > 0))
+        finished++;
+
+    drainStart = xTaskGetTickCount(); // Let the run task show everything that was accepted before we stop pairing frames
+    while ((uxQueueMessagesWaiting(queHandleIndCmdRequest) > 0 || IsIndicating) && ((xTaskGetTickCount() - drainStart) < pdMS_TO_TICKS(30000)))
+        vTaskDelay(pdMS_TO_TICKS(50));
+
+    taskENTER_CRITICAL(&stressLock);
+    stress = nullptr;
+    taskEXIT_CRITICAL(&stressLock);
+
+    stressReport(test);
+    free(test);
+    return (finished < started) ? ESP_ERR_TIMEOUT : ESP_OK;
+}
+
+void Indication::stressProducer(void *arg)
+{
+    ind_stress_producer_t *p = (ind_stress_producer_t *)arg;
+    TickType_t lastWake = xTaskGetTickCount();
+    uint32_t value = 0;
+    int64_t start = 0;
+    uint32_t elapsed = 0;
+    bool wasFull = false;
+
+    // One short flash of a producer specific color.  The producer id rides in the unused second cycles nibble.
+    value = ((uint32_t)((p->id % 7) + 1) << 28) | (0x01 << 24) | ((uint32_t)p->id << 16) | (0x01 << 8) | 0x01;
+
+    while (!p->stop)
+    {
+        start = esp_timer_get_time();
+        p->stamps[p->stampTail % IND_STRESS_STAMPS] = start; // Publish the stamp before the command can be received
+        p->stampTail++;
+
+        wasFull = (uxQueueSpacesAvailable(p->queue) == 0);
+
+        if (xQueueSendToBack(p->queue, &value, p->sendTimeout) == pdTRUE)
+        {
+            elapsed = (uint32_t)(esp_timer_get_time() - start);
+            p->sent++;
+            stressSample(p->enqueueUs, IND_STRESS_SAMPLES, &p->enqueueCount, &p->enqueueSeen, elapsed);
+        }
+        else
+        {
+            elapsed = (uint32_t)(esp_timer_get_time() - start);
+            p->stampTail--; // This command never reached the queue
+            p->dropped++;
+        }
+
+        if (wasFull)
+        {
+            p->blocked++;
+            p->blockedUs += elapsed;
+        }
+
+        xTaskDelayUntil(&lastWake, p->period);
+    }
+
+    xTaskNotifyGive(p->parent);
+    vTaskDelete(NULL);
+}
+
+void Indication::stressNoteFrame(uint32_t value)
+{
+    // Called from the run task right after the first frame of a command went out on the wire.
+    int64_t now = esp_timer_get_time();
+    uint8_t id = (0x000F0000 & value) >> 16;
+
+    taskENTER_CRITICAL(&stressLock);
+
+    if (stress != nullptr)
+    {
+        ind_stress_producer_t *p = &stress->producer[id];
+
+        if ((0x00F00000 & value) || (id >= stress->producers) || (p->stampHead == p->stampTail))
+            stress->orphans++;
+        else
+        {
+            uint32_t latency = (uint32_t)(now - p->stamps[p->stampHead % IND_STRESS_STAMPS]);
+            p->stampHead++;
+            stressSample(stress->e2eUs, IND_STRESS_E2E_SAMPLES, &stress->e2eCount, &stress->e2eSeen, latency);
+        }
+    }
+
+    taskEXIT_CRITICAL(&stressLock);
+}
+
+void Indication::stressReport(ind_stress_t *test)
+{
+    uint32_t *merged = (uint32_t *)calloc(IND_STRESS_MAX_PRODUCERS * IND_STRESS_SAMPLES, sizeof(uint32_t));
+    uint32_t mergedCount = 0;
+    uint32_t sent = 0;
+    uint32_t dropped = 0;
+
+    printf("\nIndication command queue stress test\n");
+    printf("  producers %d  period %ldms  duration %ldms  send timeout %ldms  queue depth %d\n", test->producers, test->periodMs, test->durationMs,
+           test->sendTimeoutMs, (int)(uxQueueMessagesWaiting(queHandleIndCmdRequest) + uxQueueSpacesAvailable(queHandleIndCmdRequest)));
+    printf("  producer   sent      dropped   blocked   blocked_ms\n");
+
+    for (uint8_t i = 0; i < test->producers; i++)
+    {
+        ind_stress_producer_t *p = &test->producer[i];
+        printf("  %-8d   %-8ld  %-8ld  %-8ld  %lld\n", i, p->sent, p->dropped, p->blocked, p->blockedUs / 1000);
+
+        sent += p->sent;
+        dropped += p->dropped;
+
+        if (merged != nullptr)
+        {
+            memcpy(&merged[mergedCount], p->enqueueUs, p->enqueueCount * sizeof(uint32_t));
+            mergedCount += p->enqueueCount;
+        }
+    }
+
+    printf("  total      %-8ld  %-8ld\n", sent, dropped);
+    printf("  latency (us)       samples   p50       p90       p99       max\n");
+
+    if (merged != nullptr)
+    {
+        std::sort(merged, merged + mergedCount);
+        printf("  enqueue            %-8ld  %-8ld  %-8ld  %-8ld  %ld\n", mergedCount, stressPercentile(merged, mergedCount, 50), stressPercentile(merged, mergedCount, 90),
+               stressPercentile(merged, mergedCount, 99), stressPercentile(merged, mergedCount, 100));
+        free(merged);
+    }
+
+    std::sort(test->e2eUs, test->e2eUs + test->e2eCount);
+    printf("  command-to-frame   %-8ld  %-8ld  %-8ld  %-8ld  %ld\n", test->e2eCount, stressPercentile(test->e2eUs, test->e2eCount, 50), stressPercentile(test->e2eUs, test->e2eCount, 90),
+           stressPercentile(test->e2eUs, test->e2eCount, 99), stressPercentile(test->e2eUs, test->e2eCount, 100));
+
+    if (test->orphans > 0)
+        printf("  %ld frames could not be paired with a producer stamp\n", test->orphans);
+}
+
+/* Class Isolation */
+esp_err_t Indication::runClassIsolationTest(uint32_t alarms, uint32_t periodMs)
+{
+    esp_err_t ret = ESP_OK;
+    ind_isolation_filler_t filler = {};
+    QueueHandle_t routine = queHandleIndPriority[(uint8_t)IND_PRIORITY::Routine];
+    uint8_t policy = quePolicy;
+    uint32_t *latencyUs = nullptr;
+    uint32_t seen = 0;
+    uint32_t count = 0;
+    uint32_t timedOut = 0;
+    uint32_t whileFull = 0; // Alarm submits made while the Routine queue really was full
+    TickType_t fillStart = 0;
+    int64_t start = 0;
+
+    ESP_RETURN_ON_FALSE(alarms > 0, ESP_ERR_INVALID_ARG, TAG, "alarms can not be zero");
+    ESP_RETURN_ON_FALSE(routine != nullptr, ESP_ERR_INVALID_STATE, TAG, "command queue does not exist");
+    ESP_RETURN_ON_FALSE(stress == nullptr, ESP_ERR_INVALID_STATE, TAG, "a stress test is already running");
+
+    latencyUs = (uint32_t *)calloc(IND_ISOLATION_SAMPLES, sizeof(uint32_t));
+    ESP_RETURN_ON_FALSE(latencyUs, ESP_ERR_NO_MEM, TAG, "Memory for latency samples allocation failed...");
+
+    setQueuePolicy(QUE_Block); // Routine submitters must wait on the full queue, and nothing may coalesce
+    ulTaskNotifyTake(pdTRUE, 0);
+
+    filler.ind = this;
+    filler.parent = xTaskGetCurrentTaskHandle();
+
+    if (xTaskCreate(isolationFiller, "ind_fill", 3072, &filler, TASK_PRIORITY_LOW, NULL) != pdPASS)
+    {
+        routeLogByValue(LOG_TYPE::ERROR, "%s(): Unable to create the Routine filler", __func__);
+        setQueuePolicy(policy);
+        free(latencyUs);
+        return ESP_ERR_NO_MEM;
+    }
+
+    fillStart = xTaskGetTickCount();
+    while ((uxQueueSpacesAvailable(routine) > 0) && ((xTaskGetTickCount() - fillStart) < pdMS_TO_TICKS(1000)))
+        vTaskDelay(1);
+
+    for (uint32_t i = 0; i < alarms; i++)
+    {
+        if (uxQueueSpacesAvailable(routine) == 0)
+            whileFull++;
+
+        start = esp_timer_get_time();
+        if (submitIndication(IND_ISOLATION_ALARM, pdMS_TO_TICKS(periodMs), IND_PRIORITY::Alarm) == ESP_OK)
+            stressSample(latencyUs, IND_ISOLATION_SAMPLES, &count, &seen, (uint32_t)(esp_timer_get_time() - start));
+        else
+            timedOut++;
+
+        vTaskDelay(std::max<TickType_t>(pdMS_TO_TICKS(periodMs), 1));
+    }
+
+    filler.stop = true;
+    if (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(1000)) < 1) // The filler gives up its last submit within 100mSec
+        ret = ESP_ERR_TIMEOUT;
+
+    setQueuePolicy(policy);
+
+    std::sort(latencyUs, latencyUs + count);
+    printf("\nIndication class isolation test\n");
+    printf("  alarms %ld  period %ldms  made while routine was full %ld  timed out %ld\n", alarms, periodMs, whileFull, timedOut);
+    printf("  routine submits %ld  timed out %ld\n", filler.sent + filler.timedOut, filler.timedOut);
+    printf("  latency (us)       samples   p50       p90       p99       max\n");
+    printf("  alarm submit       %-8ld  %-8ld  %-8ld  %-8ld  %ld\n", count, stressPercentile(latencyUs, count, 50), stressPercentile(latencyUs, count, 90),
+           stressPercentile(latencyUs, count, 99), stressPercentile(latencyUs, count, 100));
+
+    free(latencyUs);
+    return ret;
+}
+
+void Indication::isolationFiller(void *arg)
+{
+    ind_isolation_filler_t *f = (ind_isolation_filler_t *)arg;
+
+    while (!f->stop)
+    {
+        if (f->ind->submitIndication(IND_ISOLATION_ROUTINE, pdMS_TO_TICKS(100), IND_PRIORITY::Routine) == ESP_OK)
+            f->sent++;
+        else
+            f->timedOut++;
+    }
+
+    xTaskNotifyGive(f->parent);
+    vTaskDelete(NULL);
+}
+
+/* Jitter Benchmark */
+esp_err_t Indication::runJitterBenchmark(const ind_bench_load_t *load, uint32_t durationMs)
+{
+    esp_err_t ret = ESP_OK;
+    ind_bench_t *test = nullptr;
+    ind_snapshot_t snap = {};
+    esp_timer_handle_t timer = nullptr;
+    esp_timer_create_args_t args = {};
+    uint8_t started = 0;
+    uint8_t finished = 0;
+
+    ESP_RETURN_ON_FALSE(load, ESP_ERR_INVALID_ARG, TAG, "load can not be null...");
+    ESP_RETURN_ON_FALSE(load->tasks <= IND_BENCH_MAX_LOAD, ESP_ERR_INVALID_ARG, TAG, "tasks must be 0 to 8");
+    ESP_RETURN_ON_FALSE(load->dutyPct <= 100, ESP_ERR_INVALID_ARG, TAG, "dutyPct must be 0 to 100");
+    ESP_RETURN_ON_FALSE((load->timerHz == 0) || (load->timerBusyUs < (1000000 / load->timerHz)), ESP_ERR_INVALID_ARG, TAG, "timer load would never finish");
+    ESP_RETURN_ON_FALSE(bench == nullptr, ESP_ERR_INVALID_STATE, TAG, "a jitter benchmark is already running");
+
+    test = (ind_bench_t *)calloc(1, sizeof(ind_bench_t));
+    ESP_RETURN_ON_FALSE(test, ESP_ERR_NO_MEM, TAG, "Memory for ind_bench_t allocation failed...");
+
+    getSnapshot(&snap); // The pattern in place now comes back when we finish
+    ulTaskNotifyTake(pdTRUE, 0);
+
+    for (uint8_t i = 0; i < load->tasks; i++)
+    {
+        ind_bench_task_t *t = &test->task[i];
+
+        t->parent = xTaskGetCurrentTaskHandle();
+        t->dutyPct = load->dutyPct;
+
+        if (xTaskCreatePinnedToCore(benchLoadTask, "ind_load", 2048, t, load->priority, NULL, (load->core < 0) ? tskNO_AFFINITY : load->core) == pdPASS)
+            started++;
+        else
+            routeLogByValue(LOG_TYPE::ERROR, "%s(): Unable to create load task %d", __func__, i);
+    }
+
+    if (load->timerHz > 0)
+    {
+        test->timerBusyUs = load->timerBusyUs;
+        args.callback = &benchTimerLoad;
+        args.arg = test;
+        args.dispatch_method = ESP_TIMER_TASK;
+        args.name = "ind_bench";
+        args.skip_unhandled_events = true;
+
+        ESP_GOTO_ON_ERROR(esp_timer_create(&args, &timer), ind_runJitterBenchmark_err, TAG, "esp_timer_create() failed");
+        ESP_GOTO_ON_ERROR(esp_timer_start_periodic(timer, 1000000 / load->timerHz), ind_runJitterBenchmark_err, TAG, "esp_timer_start_periodic() failed");
+    }
+
+    taskENTER_CRITICAL(&stressLock);
+    bench = test; // The run task now measures every call
+    taskEXIT_CRITICAL(&stressLock);
+
+    setPersistentIndication(IND_BENCH_PATTERN);
+    vTaskDelay(pdMS_TO_TICKS(durationMs));
+
+    taskENTER_CRITICAL(&stressLock);
+    bench = nullptr;
+    taskEXIT_CRITICAL(&stressLock);
+
+    if (snap.persistValue != IND_CMD_WAKE)
+        setPersistentIndication(snap.persistValue);
+    else
+        cancelPersistentIndication();
+
+ind_runJitterBenchmark_err:
+    if (timer != nullptr)
+    {
+        esp_timer_stop(timer);
+        esp_timer_delete(timer);
+    }
+
+    for (uint8_t i = 0; i < load->tasks; i++)
+        test->task[i].stop = true;
+
+    while ((finished < started) && (ulTaskNotifyTake(pdFALSE, pdMS_TO_TICKS(1000)) > 0))
+        finished++;
+
+    if (ret == ESP_OK)
+        benchReport(test, load);
+
+    if (finished < started)
+        ret = ESP_ERR_TIMEOUT; // A load task is still spinning and owns its slot in test, so we must leak it
+    else
+        free(test);
+    return ret;
+}
+
+void Indication::benchLoadTask(void *arg)
+{
+    ind_bench_task_t *t = (ind_bench_task_t *)arg;
+    TickType_t lastWake = xTaskGetTickCount();
+    TickType_t window = std::max<TickType_t>(pdMS_TO_TICKS(10), 1);
+    int64_t busyUs = 0;
+    int64_t start = 0;
+
+    busyUs = ((int64_t)pdTICKS_TO_MS(window) * 1000 * t->dutyPct) / 100;
+
+    while (!t->stop)
+    {
+        start = esp_timer_get_time();
+        while ((esp_timer_get_time() - start) < busyUs) // Spin for our share of the window
+            ;
+        xTaskDelayUntil(&lastWake, window);
+    }
+
+    xTaskNotifyGive(t->parent);
+    vTaskDelete(NULL);
+}
+
+void Indication::benchTimerLoad(void *arg)
+{
+    int64_t start = esp_timer_get_time();
+
+    while ((esp_timer_get_time() - start) < ((ind_bench_t *)arg)->timerBusyUs)
+        ;
+}
+
+void Indication::benchNoteEdge(void)
+{
+    int64_t now = esp_timer_get_time();
+    int64_t late = now - edgeDueUs;
+
+    taskENTER_CRITICAL(&stressLock);
+
+    if (bench != nullptr)
+    {
+        if (edgeDueUs == 0)
+            bench->untimed++;
+        else if (late < 0)
+        {
+            bench->early++;
+            if ((uint32_t)-late > bench->earlyMaxUs)
+                bench->earlyMaxUs = (uint32_t)-late;
+        }
+        else
+            stressSample(bench->lateUs, IND_BENCH_SAMPLES, &bench->lateCount, &bench->lateSeen, (uint32_t)late);
+    }
+
+    taskEXIT_CRITICAL(&stressLock);
+}
+
+void Indication::benchReport(ind_bench_t *test, const ind_bench_load_t *load)
+{
+    printf("\nIndication jitter benchmark\n");
+    printf("  run task priority %ld  load tasks %d at priority %d core %d duty %d%%  timer load %ldHz x %ldus\n", uxTaskPriorityGet(taskHandleRun), load->tasks,
+           (int)load->priority, load->core, load->dutyPct, load->timerHz, load->timerBusyUs);
+#if CONFIG_WS2812_TIMING_ESP_TIMER
+    printf("  timing source esp_timer\n");
+#else
+    printf("  timing source RTOS tick at %d Hz\n", configTICK_RATE_HZ);
+#endif
+
+    std::sort(test->lateUs, test->lateUs + test->lateCount);
+    printf("  lateness (us)      samples   p50       p99       max\n");
+    printf("  edges              %-8ld  %-8ld  %-8ld  %ld\n", test->lateSeen, stressPercentile(test->lateUs, test->lateCount, 50), stressPercentile(test->lateUs, test->lateCount, 99),
+           stressPercentile(test->lateUs, test->lateCount, 100));
+
+    if (test->early > 0)
+        printf("  %ld edges came early (worst %ldus)\n", test->early, test->earlyMaxUs);
+    printf("  %ld calls were made from idle and not timed\n", test->untimed);
+}
+
+/* Effects Benchmark */
+esp_err_t Indication::runEffectsBenchmark(uint32_t pixelsPerRun)
+{
+    const uint8_t color[3] = {64, 255, 16}; // G R B
+    const char *names[] = {"chase", "rainbow", "breathe", "wipe", "estimate", "limit"};
+    uint8_t *grb = nullptr;
+    uint8_t *full = nullptr; // A bright frame for the limiter to scale down on every call
+    uint32_t calls = 0;
+    esp_err_t ret = ESP_OK;
+    int64_t start = 0;
+    int64_t elapsedUs = 0;
+
+    ESP_RETURN_ON_FALSE(pixelsPerRun > 0, ESP_ERR_INVALID_ARG, TAG, "pixelsPerRun must be more than 0");
+
+    grb = (uint8_t *)calloc(IND_EFFECTS_MAX_PIXELS, 3);
+    full = (uint8_t *)calloc(IND_EFFECTS_MAX_PIXELS, 3);
+    ESP_GOTO_ON_FALSE(grb && full, ESP_ERR_NO_MEM, ind_runEffectsBenchmark_end, TAG, "Memory for the effects buffers allocation failed...");
+    effectRainbow(full, IND_EFFECTS_MAX_PIXELS, 0, 0x0100);
+
+    printf("\nIndication effects benchmark (%ld pixels per run)\n", pixelsPerRun);
+    printf("  kernel     pixels    calls     uSec      pixels/s\n");
+
+    for (uint8_t k = 0; k < (sizeof(names) / sizeof(names[0])); k++)
+    {
+        for (uint8_t s = 0; s < (sizeof(effectsBenchSizes) / sizeof(effectsBenchSizes[0])); s++)
+        {
+            uint16_t pixels = effectsBenchSizes[s];
+
+            calls = std::max<uint32_t>(pixelsPerRun / pixels, 1);
+            effectRainbow(grb, pixels, 0, 0x0100); // Something worth breathing on
+            vTaskDelay(1);                         // Start each run on a fresh tick so other tasks are not starved
+
+            start = esp_timer_get_time();
+            for (uint32_t n = 0; n < calls; n++)
+            {
+                switch (k)
+                {
+                case 0:
+                    effectChase(grb, pixels, color, 4, n);
+                    break;
+                case 1:
+                    effectRainbow(grb, pixels, n << 4, 0x0040);
+                    break;
+                case 2:
+                    effectBreathe(grb, pixels, n);
+                    break;
+                case 3:
+                    effectWipe(grb, pixels, color, (n % (pixels + 1)) << 8);
+                    break;
+                case 4:
+                    estimateFramePower(grb, pixels); // The cost every frame pays when it is within budget
+                    break;
+                default:
+                    memcpy(grb, full, pixels * 3); // Counted in the figure.  Without it the buffer would be within budget after one call.
+                    limitFramePower(grb, pixels, pixels * 5); // 5mA a pixel is well under what the rainbow draws
+                    break;
+                }
+            }
+            elapsedUs = std::max<int64_t>(esp_timer_get_time() - start, 1);
+
+            printf("  %-9s  %-8d  %-8ld  %-8lld  %lld\n", names[k], pixels, calls, elapsedUs, ((int64_t)calls * pixels * 1000000) / elapsedUs);
+        }
+    }
+
+ind_runEffectsBenchmark_end:
+    free(grb);
+    free(full);
+    return ret;
+}
+
+/* Heap Check */
+bool Indication::heapCheckIdle(uint32_t timeoutMs)
+{
+    TickType_t start = xTaskGetTickCount();
+
+    while ((xTaskGetTickCount() - start) < pdMS_TO_TICKS(timeoutMs))
+    {
+        if ((uxQueueMessagesWaiting(queHandleIndCmdRequest) == 0) && !IsIndicating)
+        {
+            vTaskDelay(pdMS_TO_TICKS(100)); // Let the run task finish its idle steps before we look at the heap
+            if ((uxQueueMessagesWaiting(queHandleIndCmdRequest) == 0) && !IsIndicating)
+                return true;
+        }
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    return false;
+}
+
+esp_err_t Indication::runHeapCheck(uint32_t commands, uint32_t periodMs)
+{
+    esp_err_t ret = ESP_OK;
+    size_t freeBefore = 0;
+    size_t freeAfter = 0;
+    size_t lowBefore = 0;
+    size_t lowAfter = 0;
+    uint32_t refused = 0;
+    bool claimed = false; // Both options that make up the no-heap claim are enabled
+    const char *staticText = "off";
+    const char *holdText = "off";
+
+    ESP_RETURN_ON_FALSE(commands > 0, ESP_ERR_INVALID_ARG, TAG, "commands can not be zero");
+    ESP_RETURN_ON_FALSE(queHandleIndCmdRequest != nullptr, ESP_ERR_INVALID_STATE, TAG, "command queue does not exist");
+    ESP_RETURN_ON_FALSE(stress == nullptr, ESP_ERR_INVALID_STATE, TAG, "a stress test is already running");
+
+#if CONFIG_WS2812_STATIC_ALLOCATION
+    staticText = "on";
+#endif
+#if CONFIG_WS2812_HOLD_RMT_DRIVER
+    holdText = "on";
+#endif
+#if CONFIG_WS2812_STATIC_ALLOCATION && CONFIG_WS2812_HOLD_RMT_DRIVER
+    claimed = true;
+#endif
+
+    submitIndication(IND_HEAP_CHECK_CMD, pdMS_TO_TICKS(100)); // Warm up
+    routeLogByValue(LOG_TYPE::INFO, "%s(): warm up", __func__);
+    ESP_RETURN_ON_FALSE(heapCheckIdle(IND_HEAP_CHECK_DRAIN_MS), ESP_ERR_TIMEOUT, TAG, "run task did not go idle after the warm up");
+
+    freeBefore = heap_caps_get_free_size(MALLOC_CAP_DEFAULT);
+    lowBefore = heap_caps_get_minimum_free_size(MALLOC_CAP_DEFAULT);
+
+    for (uint32_t i = 0; i < commands; i++)
+    {
+        if (submitIndication(IND_HEAP_CHECK_CMD, pdMS_TO_TICKS(100)) != ESP_OK)
+            refused++;
+        routeLogByValue(LOG_TYPE::INFO, "%s(): command %ld of %ld", __func__, i + 1, commands);
+        vTaskDelay(std::max<TickType_t>(pdMS_TO_TICKS(periodMs), 1));
+    }
+
+    if (!heapCheckIdle(IND_HEAP_CHECK_DRAIN_MS))
+        ret = ESP_ERR_TIMEOUT;
+
+    freeAfter = heap_caps_get_free_size(MALLOC_CAP_DEFAULT);
+    lowAfter = heap_caps_get_minimum_free_size(MALLOC_CAP_DEFAULT);
+
+    if (claimed && (ret == ESP_OK) && ((freeAfter < freeBefore) || (lowAfter < lowBefore)))
+        ret = ESP_FAIL;
+
+    printf("\nIndication heap check (static allocation %s, hold RMT driver %s)\n", staticText, holdText);
+    printf("  commands %ld  period %ldms  refused %ld\n", commands, periodMs, refused);
+    printf("  heap (bytes)       before    after     change\n");
+    printf("  free               %-8u  %-8u  %d\n", (unsigned)freeBefore, (unsigned)freeAfter, (int)freeAfter - (int)freeBefore);
+    printf("  low water mark     %-8u  %-8u  %d\n", (unsigned)lowBefore, (unsigned)lowAfter, (int)lowAfter - (int)lowBefore);
+
+    if (!claimed)
+        printf("  not judged -- enable both options for a pass or fail\n");
+    else if (ret == ESP_OK)
+        printf("  pass -- no heap was used by the burst\n");
+    else if (ret == ESP_FAIL)
+        printf("  FAIL -- heap was used by the burst\n");
+    else
+        printf("  not judged -- the run task did not go idle\n");
+
+    return ret;
+}
+
+#endif
@@ -0,0 +1,81 @@
+#include "indication/indication_.hpp"
+
+//
+// A ticket follows one submitted command from the queue to the LED.  submitIndication() stamps the enqueue time, the run task
+// stamps the first frame and the end of the sequence.  Each event is delivered by the ticket's callback, by task notification
+// bits, or both.  The start event happens once -- a command replayed after preemption does not start again.
+//
+// Once a ticket reaches a final state (Finished, Dropped, Coalesced or Discarded) we never touch it again, so the owner may
+// reuse or release it from inside the callback or as soon as the finish bits arrive.
+//
+
+/* Completion Tickets */
+void Indication::signalTicket(ind_ticket_t *ticket, IND_TICKET state)
+{
+    int64_t now = esp_timer_get_time();
+    ind_ticket_cb_t callback = ticket->callback; // Copied first because the owner may release the ticket after a final event
+    TaskHandle_t notifyTask = ticket->notifyTask;
+    uint32_t bits = 0;
+
+    if (state == IND_TICKET::Preempted)
+    {
+        ticket->state = state; // Waiting to be replayed -- no event
+        return;
+    }
+
+    if (state == IND_TICKET::Started)
+    {
+        if (ticket->state != IND_TICKET::Queued) // A replay after preemption
+        {
+            ticket->state = state;
+            return;
+        }
+
+        ticket->startUs = now;
+        bits = ticket->startBits;
+    }
+    else
+    {
+        ticket->finishUs = now;
+        bits = ticket->finishBits;
+    }
+
+    ticket->state = state;
+
+    if (callback != nullptr)
+        callback(ticket);
+
+    if ((notifyTask != nullptr) && (bits != 0))
+        xTaskNotify(notifyTask, bits, eSetBits);
+}
+
+void Indication::dropWaitingCmds(void)
+{
+    ind_cmd_t cmd = {};
+
+    drainIsrRing();
+
+    for (uint8_t p = 0; p < IND_PRIORITY_CLASSES; p++)
+    {
+        while (xQueueReceive(queHandleIndPriority[p], &cmd, 0) == pdTRUE)
+        {
+            if (cmd.ticket != nullptr)
+                signalTicket(cmd.ticket, IND_TICKET::Dropped);
+        }
+
+        xQueueReset(queHandleIndPattern[p]); // Pattern ids carry no ticket
+    }
+
+    while (preemptedCount > 0)
+    {
+        cmd = preempted[--preemptedCount];
+        if (cmd.ticket != nullptr)
+            signalTicket(cmd.ticket, IND_TICKET::Dropped);
+    }
+
+    dropScheduledCmds();
+
+    taskENTER_CRITICAL(&queLock);
+    quePendingCount = 0;
+    taskEXIT_CRITICAL(&queLock);
+}
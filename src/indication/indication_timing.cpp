@@ -0,0 +1,190 @@
+#include "indication/indication_.hpp"
+
+//
+// On and off times are counted in dwell steps of IND_DWELL_US.  Two timing sources are available (CONFIG_WS2812_TIMING):
+//
+// RTOS tick  -- xTaskDelayUntil() for pdMS_TO_TICKS(10).  When the tick rate is 100Hz that is a single tick, so a step ends
+//               at the next tick boundary and may be anywhere from nearly 0 to 10mSecs long.
+// esp_timer  -- a periodic microsecond timer gives a semaphore every IND_DWELL_US.  Steps keep their length whatever the tick
+//               rate is, and the timer does not drift because each period is measured from the last one, not from our wake up.
+//
+// With CONFIG_WS2812_SHARED_SCHEDULER the shared task owns the one timer (or tick) and waits out each step for every device.
+// Each device then only measures the step against the shared intended time.
+//
+// The timer only runs while an indication is in progress.  Every step is compared against the time it was meant to end and the
+// error goes into a histogram, which is how the two sources can be compared on real hardware.
+//
+static_assert(sizeof(((ind_jitter_t *)0)->bucket) / sizeof(uint32_t) == IND_JITTER_BUCKETS, "ind_jitter_t bucket count must match IND_JITTER_BUCKETS");
+
+static const uint32_t jitterLimitUs[IND_JITTER_BUCKETS - 1] = {50, 100, 250, 500, 1000, 2500, 5000};
+
+/* Dwell Timing */
+void Indication::createDwellTimer(void)
+{
+#if CONFIG_WS2812_TIMING_ESP_TIMER && !CONFIG_WS2812_SHARED_SCHEDULER
+    esp_err_t ret = ESP_OK;
+    esp_timer_create_args_t args = {};
+
+    semDwell = IND_SEMAPHORE_CREATE_BINARY(&semDwellBuffer); // Starts empty.  The timer gives it once per step.
+    ESP_GOTO_ON_FALSE(semDwell, ESP_ERR_NO_MEM, ind_createDwellTimer_err, TAG, "IDF did not allocate memory for the dwell semaphore.");
+
+    args.callback = &dwellTimerCallback;
+    args.arg = this;
+    args.dispatch_method = ESP_TIMER_TASK;
+    args.name = "ind_dwell";
+    args.skip_unhandled_events = true; // A step we could not serve is simply late.  We never want a burst of catch-up steps.
+
+    ESP_GOTO_ON_ERROR(esp_timer_create(&args, &dwellTimer), ind_createDwellTimer_err, TAG, "esp_timer_create() failed");
+    return;
+
+ind_createDwellTimer_err:
+    routeLogByValue(LOG_TYPE::ERROR, "%s(): error: %s", __func__, esp_err_to_name(ret));
+#endif
+}
+
+void Indication::destroyDwellTimer(void)
+{
+#if CONFIG_WS2812_TIMING_ESP_TIMER && !CONFIG_WS2812_SHARED_SCHEDULER
+    if (dwellTimer != nullptr)
+    {
+        if (dwellTimerRunning)
+            esp_timer_stop(dwellTimer);
+        esp_timer_delete(dwellTimer);
+        dwellTimer = nullptr;
+        dwellTimerRunning = false;
+    }
+
+    if (semDwell != nullptr)
+    {
+        vSemaphoreDelete(semDwell);
+        semDwell = nullptr;
+    }
+#endif
+}
+
+#if CONFIG_WS2812_TIMING_ESP_TIMER
+void Indication::dwellTimerCallback(void *arg)
+{
+    xSemaphoreGive(static_cast<Indication *>(arg)->semDwell); // Runs in the esp_timer task
+}
+#endif
+
+void Indication::waitDwell(void)
+{
+    int64_t now = 0;
+
+#if CONFIG_WS2812_SHARED_SCHEDULER
+    now = esp_timer_get_time(); // The shared task has already waited out this step
+    noteDwellError(now - sharedEdgeUs);
+    edgeDueUs = sharedEdgeUs;
+#elif CONFIG_WS2812_TIMING_ESP_TIMER
+    if (!dwellTimerRunning)
+    {
+        xSemaphoreTake(semDwell, 0); // Forget a give left over from the last indication
+        if (esp_timer_start_periodic(dwellTimer, IND_DWELL_US) == ESP_OK)
+        {
+            dwellTimerRunning = true;
+            dwellDueUs = esp_timer_get_time() + IND_DWELL_US;
+        }
+    }
+
+    if (dwellTimerRunning)
+        xSemaphoreTake(semDwell, pdMS_TO_TICKS(4 * IND_DWELL_US / 1000) + 1); // The timeout only guards against a stopped timer
+    else
+        vTaskDelay(pdMS_TO_TICKS(IND_DWELL_US / 1000) + 1); // Could not start the timer -- fall back to the tick
+
+    now = esp_timer_get_time();
+    noteDwellError(now - dwellDueUs);
+    edgeDueUs = dwellDueUs;
+    dwellDueUs += IND_DWELL_US;
+
+    while (dwellDueUs <= now) // Steps we slept through are not owed.  Line up with the next timer period.
+        dwellDueUs += IND_DWELL_US;
+#else
+    TickType_t startDwellTime = xTaskGetTickCount();
+
+    // We want our dwell time to be about 10mSecs.  When the RTOS tick rate is 100Hz, our dwellTime ticks are only 1.
+    // If we should increase our tick rate upward, pdMS_TO_TICKS() calculates a new tick dwellTime for us.
+    dwellDueUs = esp_timer_get_time() + IND_DWELL_US;
+    xTaskDelayUntil(&startDwellTime, pdMS_TO_TICKS(IND_DWELL_US / 1000));
+
+    now = esp_timer_get_time();
+    noteDwellError(now - dwellDueUs);
+    edgeDueUs = dwellDueUs;
+#endif
+}
+
+void Indication::stopDwell(void)
+{
+    edgeDueUs = 0; // Work done while idle is not paced by a dwell step
+
+#if CONFIG_WS2812_TIMING_ESP_TIMER && !CONFIG_WS2812_SHARED_SCHEDULER
+    if (dwellTimerRunning)
+    {
+        esp_timer_stop(dwellTimer);
+        dwellTimerRunning = false;
+    }
+#endif
+}
+
+void Indication::noteDwellError(int64_t errorUs)
+{
+    uint32_t absUs = (uint32_t)((errorUs < 0) ? -errorUs : errorUs); // Early is as wrong as late
+    uint8_t b = 0;
+
+    while ((b < (IND_JITTER_BUCKETS - 1)) && (absUs >= jitterLimitUs[b]))
+        b++;
+
+    taskENTER_CRITICAL(&jitterLock);
+    jitter.samples++;
+    jitter.bucket[b]++;
+    jitter.totalUs += absUs;
+    if (absUs > jitter.maxUs)
+        jitter.maxUs = absUs;
+    taskEXIT_CRITICAL(&jitterLock);
+}
+
+/* Jitter Statistics */
+void Indication::getJitterStats(ind_jitter_t *stats)
+{
+    if (stats == nullptr)
+        return;
+
+    taskENTER_CRITICAL(&jitterLock);
+    *stats = jitter;
+    taskEXIT_CRITICAL(&jitterLock);
+}
+
+void Indication::resetJitterStats(void)
+{
+    taskENTER_CRITICAL(&jitterLock);
+    jitter = {};
+    taskEXIT_CRITICAL(&jitterLock);
+}
+
+void Indication::printJitterStats(void)
+{
+    ind_jitter_t stats = {};
+    uint32_t lower = 0;
+
+    getJitterStats(&stats);
+
+#if CONFIG_WS2812_TIMING_ESP_TIMER
+    printf("Dwell step timing error (esp_timer, %d uSec steps)\n", IND_DWELL_US);
+#else
+    printf("Dwell step timing error (RTOS tick at %d Hz, %d uSec steps)\n", configTICK_RATE_HZ, IND_DWELL_US);
+#endif
+
+    for (uint8_t b = 0; b < IND_JITTER_BUCKETS; b++)
+    {
+        if (b < (IND_JITTER_BUCKETS - 1))
+        {
+            printf("  %5ld - %5ld uSec  %ld\n", lower, jitterLimitUs[b] - 1, stats.bucket[b]);
+            lower = jitterLimitUs[b];
+        }
+        else
+            printf("  %5ld +     uSec  %ld\n", lower, stats.bucket[b]);
+    }
+
+    printf("  samples %ld  mean %ld uSec  max %ld uSec\n", stats.samples, (stats.samples > 0) ? (uint32_t)(stats.totalUs / stats.samples) : 0, stats.maxUs);
+}
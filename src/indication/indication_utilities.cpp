@@ -1,7 +1,7 @@
 #include "indication/indication_.hpp"
 
 /* Untilities */
-std::string Indication::getStateText(LED_STATE colorState)
+const char *Indication::getStateText(LED_STATE colorState)
 {
     switch (colorState)
     {